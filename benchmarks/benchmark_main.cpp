@@ -1,14 +1,342 @@
 #include <benchmark/benchmark.h>
 
-static void BM_Example(benchmark::State& state) {
-    for (auto _ : state) {
-        // Benchmark code here
-        int x = 0;
-        for (int i = 0; i < 1000; ++i) {
-            x += i;
-        }
-    }
-}
-BENCHMARK(BM_Example);
-
-BENCHMARK_MAIN();
\ No newline at end of file
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_mouse.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+import actorStore;
+import editor;
+import game;
+import grid;
+import levelBinary;
+import levelLoader;
+import tileStore;
+
+// the benchmarks load the tileset from rsrc/ and test.lvl, they have to run
+// from the root of the repository
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+/// report the allocations made during its lifetime, per iteration
+class AllocationCounter {
+public:
+  explicit AllocationCounter(benchmark::State &state)
+      : state_{&state}, start_{allocations.load()} {}
+
+  AllocationCounter(const AllocationCounter &) = delete;
+  AllocationCounter(AllocationCounter &&) = delete;
+  auto operator=(const AllocationCounter &) -> AllocationCounter & = delete;
+  auto operator=(AllocationCounter &&) -> AllocationCounter & = delete;
+
+  ~AllocationCounter() {
+    state_->counters["allocs/iter"] = benchmark::Counter(
+        static_cast<double>(allocations.load() - start_),
+        benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State *state_;
+  std::size_t start_;
+};
+
+/// build a level of tileCount tiles on a square of cells, one tile in four
+/// being a wall
+auto syntheticLevel(const Game &game, std::size_t tileCount)
+    -> const std::string & {
+  static std::map<std::size_t, std::string> levels;
+  if (auto levelIt = levels.find(tileCount); levelIt != levels.end()) {
+    return levelIt->second;
+  }
+
+  const auto catalog = game.getCatalog();
+  const auto side = static_cast<std::size_t>(
+      std::ceil(std::sqrt(static_cast<double>(tileCount))));
+
+  std::ostringstream floor;
+  std::ostringstream wall;
+  for (std::size_t index = 0; index < tileCount; ++index) {
+    const Cell cell{.x = static_cast<int>(index % side),
+                    .y = static_cast<int>(index / side)};
+    const auto &kind = catalog[index % catalog.size()];
+    auto &layer = index % 4 == 3 ? wall : floor;
+    kind.serialize(layer, tilePosOf(cell), false);
+    layer << '\n';
+  }
+  return levels.emplace(tileCount, floor.str() + "=====\n" + wall.str())
+      .first->second;
+}
+
+/// read test.lvl, or a synthetic level when tileCount is not 0
+auto levelText(const Game &game, std::size_t tileCount) -> std::string {
+  if (tileCount != 0) {
+    return syntheticLevel(game, tileCount);
+  }
+  std::ifstream file{"test.lvl"};
+  std::ostringstream text;
+  text << file.rdbuf();
+  return text.str();
+}
+
+/// make a headless game keeping no journal, whose records would pile up
+/// unflushed as the benchmarks apply edits without rendering frames
+auto makeGame() -> Game {
+  return Game{{.headless = true,
+               .clock = [] { return Uint64{}; },
+               .journalPath = {}}};
+}
+
+auto loadedTiles(const Game &game) -> std::size_t {
+  return game.getMap().size() + game.getMapWall().size();
+}
+
+/// build a level of a few floor tiles and enemyCount enemies, every enemy
+/// standing in the area visible at the start
+auto enemyLevel(const Game &game, std::size_t enemyCount) -> std::string {
+  const auto kinds = game.getEnemyKinds();
+  std::ostringstream level;
+  level << syntheticLevel(game, 1'000) << "=====\n";
+  for (std::size_t index = 0; index < enemyCount; ++index) {
+    level << kinds[index % kinds.size()].name() << ' ' << (index % 600)
+          << ' ' << 24 + (index / 600 * 4 % 320) << ' ' << index % 2
+          << '\n';
+  }
+  return level.str();
+}
+
+auto levelSizes(benchmark::internal::Benchmark *bench) -> void {
+  bench->Arg(0)->Arg(1'000)->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+}
+
+} // namespace
+
+auto operator new(std::size_t size) -> void * {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+auto operator delete(void *ptr) noexcept -> void { std::free(ptr); }
+
+auto operator delete(void *ptr, std::size_t /*size*/) noexcept -> void {
+  std::free(ptr);
+}
+
+static void BM_Render(benchmark::State &state) {
+  auto game = makeGame();
+  std::istringstream level{levelText(game, state.range(0))};
+  game.loadLevel(level);
+
+  // bake every visible chunk before measuring
+  game.render();
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    game.render();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["tiles"] = static_cast<double>(loadedTiles(game));
+}
+BENCHMARK(BM_Render)->Apply(levelSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_WallSort(benchmark::State &state) {
+  auto game = makeGame();
+  std::istringstream level{levelText(game, state.range(0))};
+  game.loadLevel(level);
+
+  const auto &walls = game.getMapWall();
+  const auto catalog = game.getCatalog();
+  SpatialIndex<TileSlot> index;
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    index.clear();
+    walls.forEach([&](TileSlot slot) {
+      index.append(walls.cell(slot), wallSortKey(walls, catalog, slot), slot);
+    });
+    index.sort();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(walls.size()));
+}
+BENCHMARK(BM_WallSort)->Apply(levelSizes)->Unit(benchmark::kMicrosecond);
+
+static void BM_Enemies(benchmark::State &state) {
+  auto game = makeGame();
+  game.parseLevel(
+      enemyLevel(game, static_cast<std::size_t>(state.range(0))));
+  game.render();
+
+  // the enemies stand still, a frame collects, sorts, animates and draws them
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    game.render();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(game.getEnemyCount()));
+}
+BENCHMARK(BM_Enemies)
+    ->Arg(1'000)
+    ->Arg(10'000)
+    ->Arg(50'000)
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_EditorPlacement(benchmark::State &state) {
+  auto game = makeGame();
+  std::istringstream level{levelText(game, state.range(0))};
+  game.loadLevel(level);
+
+  constexpr int columns{64};
+  constexpr int rows{32};
+  constexpr float cellPixels{32};
+
+  SDL_Event event{};
+  event.button.button = SDL_BUTTON_LEFT;
+
+  int placement{0};
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    event.button.x = static_cast<float>(placement % columns) * cellPixels;
+    event.button.y =
+        static_cast<float>(placement / columns % rows) * cellPixels;
+    // a click is a one cell stroke, applied on release
+    event.type = SDL_EVENT_MOUSE_BUTTON_DOWN;
+    benchmark::DoNotOptimize(game.processEventEditor(event));
+    event.type = SDL_EVENT_MOUSE_BUTTON_UP;
+    benchmark::DoNotOptimize(game.processEventEditor(event));
+    ++placement;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EditorPlacement)->Apply(levelSizes);
+
+static void BM_EditorBatch(benchmark::State &state) {
+  auto game = makeGame();
+  std::istringstream level{levelText(game, state.range(0))};
+  game.loadLevel(level);
+
+  constexpr int side{64};
+  std::vector<TileEdit> place;
+  std::vector<TileEdit> erase;
+  CellArea{.first = {.x = 0, .y = 0}, .last = {.x = side - 1, .y = side - 1}}
+      .forEach([&](const Cell &cell) {
+        place.push_back({.cell = cell, .catalogId = 0, .level = false});
+        erase.push_back(
+            {.cell = cell, .catalogId = TileStore::freeId, .level = false});
+      });
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    game.applyEdits(false, place);
+    game.applyEdits(false, erase);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * side * side);
+}
+BENCHMARK(BM_EditorBatch)
+    ->Apply(levelSizes)
+    ->Unit(benchmark::kMicrosecond);
+
+static void BM_LevelSave(benchmark::State &state) {
+  auto game = makeGame();
+  std::istringstream level{levelText(game, state.range(0))};
+  game.loadLevel(level);
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    std::ostringstream output;
+    game.saveLevel(output);
+    benchmark::DoNotOptimize(output.tellp());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(loadedTiles(game)));
+}
+BENCHMARK(BM_LevelSave)->Apply(levelSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_LevelLoad(benchmark::State &state) {
+  auto game = makeGame();
+  const auto text = levelText(game, state.range(0));
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    std::istringstream level{text};
+    game.loadLevel(level);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(loadedTiles(game)));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(text.size()));
+}
+BENCHMARK(BM_LevelLoad)->Apply(levelSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_LevelParse(benchmark::State &state) {
+  auto game = makeGame();
+  const auto text = levelText(game, state.range(0));
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    game.parseLevel(text);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(loadedTiles(game)));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(text.size()));
+}
+BENCHMARK(BM_LevelParse)->Apply(levelSizes)->Unit(benchmark::kMillisecond);
+
+static void BM_BinaryLevelLoad(benchmark::State &state) {
+  auto game = makeGame();
+  std::istringstream level{levelText(game, state.range(0))};
+  game.loadLevel(level);
+
+  const auto path = std::filesystem::temp_directory_path() /
+                    std::format("benchmark_{}.lvlb", state.range(0));
+  {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    // the level is measured on its tiles, it is saved without enemies
+    saveBinaryLevel(file, game.getCatalog(), game.getMap(), game.getMapWall(),
+                    {}, ActorStore{});
+  }
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    const MappedLevel mapped{path};
+    game.loadBinaryLevel(mapped);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(loadedTiles(game)));
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_BinaryLevelLoad)
+    ->Apply(levelSizes)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_LoadEntities(benchmark::State &state) {
+  auto game = makeGame();
+
+  AllocationCounter counter{state};
+  for (auto _ : state) {
+    game.loadEntities();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(game.getCatalog().size()));
+}
+BENCHMARK(BM_LoadEntities)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+export module actorStore;
+
+import sprite;
+
+/// index of an actor in an ActorStore
+export using ActorSlot = std::uint32_t;
+
+/// index of an actor kind in the enemies of the catalog
+export using ActorKindId = std::uint16_t;
+
+/// the enemies of a level as its files hold them, one array per field
+///
+/// the level loader and saver fill and write it off the render thread, the
+/// game spawns its actors as entities of the registry and collects them back
+/// to save them, see spawnEnemies() and collectEnemies()
+export class ActorStore {
+public:
+  /// add an actor
+  ///
+  /// \param[in] KindId the kind of the actor
+  /// \param[in] Pos the position of the feet of the actor, in map pixels
+  /// \param[in] Animation the animation state of the actor
+  ///
+  /// \return the slot of the new actor
+  auto insert(ActorKindId kindId, const SDL_FPoint &pos,
+              const SpriteAnimation &animation = {}) -> ActorSlot;
+
+  /// remove every actor
+  auto clear() noexcept -> void;
+
+  /// reserve memory for a number of actors
+  auto reserve(size_t count) -> void;
+
+  /// get the number of actors
+  [[nodiscard]] auto size() const noexcept -> size_t {
+    return kindIds_.size();
+  }
+
+  [[nodiscard]] auto kindId(ActorSlot slot) const noexcept -> ActorKindId {
+    return kindIds_[slot];
+  }
+  [[nodiscard]] auto position(ActorSlot slot) const noexcept -> SDL_FPoint {
+    return positions_[slot];
+  }
+  [[nodiscard]] auto animation(ActorSlot slot) const noexcept
+      -> const SpriteAnimation & {
+    return animations_[slot];
+  }
+
+  /// call a visitor with the slot of every actor
+  template <class Visitor> auto forEach(Visitor &&visitor) const -> void {
+    for (ActorSlot slot = 0; slot < kindIds_.size(); ++slot) {
+      visitor(slot);
+    }
+  }
+
+private:
+  std::vector<ActorKindId> kindIds_;
+  std::vector<SDL_FPoint> positions_;
+  std::vector<SpriteAnimation> animations_;
+};
+
+auto ActorStore::insert(ActorKindId kindId, const SDL_FPoint &pos,
+                        const SpriteAnimation &animation) -> ActorSlot {
+  const auto slot = static_cast<ActorSlot>(kindIds_.size());
+  kindIds_.push_back(kindId);
+  positions_.push_back(pos);
+  animations_.push_back(animation);
+  return slot;
+}
+
+auto ActorStore::clear() noexcept -> void {
+  kindIds_.clear();
+  positions_.clear();
+  animations_.clear();
+}
+
+auto ActorStore::reserve(size_t count) -> void {
+  kindIds_.reserve(count);
+  positions_.reserve(count);
+  animations_.reserve(count);
+}
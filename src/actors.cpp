@@ -0,0 +1,187 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <entt/entity/registry.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+
+export module actors;
+
+import actorStore;
+import sprite;
+
+/// position of an actor, at its feet, in map pixels
+export struct Position {
+  SDL_FPoint current;
+  /// the position before the last simulation step, rendered positions are
+  /// interpolated from it
+  SDL_FPoint previous;
+};
+
+/// movement of an actor, in map pixels per millisecond
+export struct Velocity {
+  float x;
+  float y;
+};
+
+/// the kind an actor is rendered as, along with its SpriteAnimation
+export struct Sprite {
+  /// the kind of the actor, not owned, nothing is rendered when null
+  const CharacterSprite *kind;
+};
+
+/// an enemy placed in the level, saved with it
+export struct Enemy {
+  /// the kind of the enemy, indexing the enemy kinds of the catalog
+  ActorKindId kindId;
+};
+
+/// an actor to render, gathered by collectActors()
+export struct ActorDraw {
+  /// the key sorting the actor with the wall tiles, see wallSortKey()
+  float sortKey;
+  /// the interpolated position of the feet of the actor
+  SDL_FPoint pos;
+  const CharacterSprite *kind;
+  SpriteAnimation animation;
+};
+
+/// move the actors with a velocity by one simulation step
+///
+/// \param[in] Registry the registry holding the actors
+/// \param[in] DeltaTime the duration of the step in milliseconds
+export auto moveActors(entt::registry &registry, float deltaTime) noexcept
+    -> void {
+  registry.view<Position, const Velocity>().each(
+      [deltaTime](Position &position, const Velocity &velocity) {
+        position.previous = position.current;
+        position.current.x += velocity.x * deltaTime;
+        position.current.y += velocity.y * deltaTime;
+      });
+}
+
+/// advance the animation of the actors by one rendered frame
+///
+/// \param[in] Registry the registry holding the actors
+export auto animateActors(entt::registry &registry) noexcept -> void {
+  registry.view<SpriteAnimation>().each([](SpriteAnimation &animation) {
+    if (animation.hitFrames > 0) {
+      --animation.hitFrames;
+    }
+  });
+}
+
+/// add the entities visible in an area to the actors to draw
+///
+/// \param[in] Registry the registry holding the actors
+/// \param[in] Interpolation the progress from the previous simulation step
+/// to the last one
+/// \param[in] View the visible area, in rendered pixels
+/// \param[out] Draws the visible actors, appended to
+export auto collectActors(const entt::registry &registry, float interpolation,
+                          const SDL_FRect &view,
+                          std::vector<ActorDraw> &draws) -> void {
+  registry.view<const Position, const Sprite, const SpriteAnimation>().each(
+      [&](const Position &position, const Sprite &sprite,
+          const SpriteAnimation &animation) {
+        if (sprite.kind == nullptr) {
+          return;
+        }
+        const SDL_FPoint pos{
+            std::lerp(position.previous.x, position.current.x, interpolation),
+            std::lerp(position.previous.y, position.current.y,
+                      interpolation)};
+        const auto destRect = sprite.kind->getDestRect(pos);
+        if (!SDL_HasRectIntersectionFloat(&destRect, &view)) {
+          return;
+        }
+        draws.push_back({.sortKey = pos.y,
+                         .pos = pos,
+                         .kind = sprite.kind,
+                         .animation = animation});
+      });
+}
+
+/// sort the actors to draw by sort key, to merge them with the wall tiles
+export auto sortActors(std::vector<ActorDraw> &draws) -> void {
+  std::ranges::sort(draws, {}, &ActorDraw::sortKey);
+}
+
+/// get the sprite of an enemy kind, null when the kind is unknown
+auto enemySprite(std::span<const CharacterSprite> kinds, ActorKindId kindId)
+    -> Sprite {
+  return {.kind = kindId < kinds.size() ? &kinds[kindId] : nullptr};
+}
+
+/// add an enemy standing at a position
+///
+/// \param[in] Registry the registry holding the actors
+/// \param[in] Kinds the enemy kinds indexed by kind id, they have to outlive
+/// the enemy, see bindEnemyKinds()
+/// \param[in] KindId the kind of the enemy
+/// \param[in] Pos the position of the feet of the enemy, in map pixels
+/// \param[in] Animation the animation state of the enemy
+export auto spawnEnemy(entt::registry &registry,
+                       std::span<const CharacterSprite> kinds,
+                       ActorKindId kindId, const SDL_FPoint &pos,
+                       const SpriteAnimation &animation) -> entt::entity {
+  const auto enemy = registry.create();
+  registry.emplace<Enemy>(enemy, Enemy{.kindId = kindId});
+  registry.emplace<Position>(enemy, Position{.current = pos, .previous = pos});
+  registry.emplace<Sprite>(enemy, enemySprite(kinds, kindId));
+  registry.emplace<SpriteAnimation>(enemy, animation);
+  return enemy;
+}
+
+/// remove every enemy
+export auto destroyEnemies(entt::registry &registry) -> void {
+  const auto enemies = registry.view<const Enemy>();
+  registry.destroy(enemies.begin(), enemies.end());
+}
+
+/// replace the enemies with the ones of a level
+///
+/// \param[in] Registry the registry holding the actors
+/// \param[in] Enemies the enemies of the level
+/// \param[in] Kinds the enemy kinds indexed by kind id, they have to outlive
+/// the enemies, see bindEnemyKinds()
+export auto spawnEnemies(entt::registry &registry, const ActorStore &enemies,
+                         std::span<const CharacterSprite> kinds) -> void {
+  destroyEnemies(registry);
+  enemies.forEach([&](ActorSlot slot) {
+    spawnEnemy(registry, kinds, enemies.kindId(slot), enemies.position(slot),
+               enemies.animation(slot));
+  });
+}
+
+/// gather the enemies to save them with the level
+///
+/// \param[in] Registry the registry holding the actors
+/// \param[out] Enemies the enemies, replaced
+export auto collectEnemies(const entt::registry &registry,
+                           ActorStore &enemies) -> void {
+  enemies.clear();
+  registry.view<const Enemy, const Position, const SpriteAnimation>().each(
+      [&enemies](const Enemy &enemy, const Position &position,
+                 const SpriteAnimation &animation) {
+        enemies.insert(enemy.kindId, position.current, animation);
+      });
+}
+
+/// point the sprites of the enemies to new enemy kinds, after the catalog
+/// has been loaded again
+///
+/// \param[in] Registry the registry holding the actors
+/// \param[in] Kinds the enemy kinds indexed by kind id, they have to outlive
+/// the enemies
+export auto bindEnemyKinds(entt::registry &registry,
+                           std::span<const CharacterSprite> kinds) -> void {
+  registry.view<const Enemy, Sprite>().each(
+      [kinds](const Enemy &enemy, Sprite &sprite) {
+        sprite = enemySprite(kinds, enemy.kindId);
+      });
+}
@@ -0,0 +1,41 @@
+module;
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <array>
+#include <cstddef>
+
+export module animation;
+
+/// animation frame indices shared by every animated sprite
+///
+/// the clock is updated once per frame and publishes the current frame index
+/// for each animation length so sprites only have to look it up
+export class AnimationClock {
+public:
+  /// the longest animation supported
+  static constexpr size_t maxClipLength{8};
+
+  /// move the clock to a time
+  ///
+  /// \param[in] Now the time in milliseconds
+  auto update(Uint64 now) noexcept -> void {
+    const auto step = now / stepDuration;
+    for (size_t clipLength = 1; clipLength <= maxClipLength; ++clipLength) {
+      frames_[clipLength] = static_cast<size_t>(step % clipLength);
+    }
+  }
+
+  /// get the current frame of an animation
+  ///
+  /// \param[in] ClipLength the number of frames of the animation
+  [[nodiscard]] auto frame(size_t clipLength) const noexcept -> size_t {
+    return frames_[clipLength];
+  }
+
+private:
+  /// the duration of an animation frame in milliseconds
+  static constexpr Uint64 stepDuration{1000 / 15};
+
+  std::array<size_t, maxClipLength + 1> frames_{};
+};
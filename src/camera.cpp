@@ -0,0 +1,69 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <algorithm>
+
+export module camera;
+
+/// the part of the map shown in the window
+///
+/// the camera converts between screen pixels and map pixels, the map pixels
+/// being the screen pixels when the camera is at (0, 0) without zoom
+export class Camera {
+public:
+  /// get the map point shown at the top left corner of the window
+  [[nodiscard]] auto getOrigin() const noexcept -> SDL_FPoint {
+    return origin_;
+  }
+
+  /// get the number of screen pixels per map pixel
+  [[nodiscard]] auto getZoom() const noexcept -> float { return zoom_; }
+
+  /// move the camera
+  ///
+  /// \param[in] Delta the displacement in screen pixels
+  auto move(const SDL_FPoint &delta) noexcept -> void {
+    origin_.x += delta.x / zoom_;
+    origin_.y += delta.y / zoom_;
+  }
+
+  /// zoom in or out keeping the same map point under a screen point
+  ///
+  /// \param[in] Factor the zoom multiplier
+  /// \param[in] Anchor the screen point that does not move
+  auto zoomAt(float factor, const SDL_FPoint &anchor) noexcept -> void {
+    const auto before = screenToMap(anchor);
+    zoom_ = std::clamp(zoom_ * factor, minZoom, maxZoom);
+    origin_ = {before.x - (anchor.x / zoom_), before.y - (anchor.y / zoom_)};
+  }
+
+  /// convert a point in screen pixels to map pixels
+  [[nodiscard]] auto screenToMap(const SDL_FPoint &point) const noexcept
+      -> SDL_FPoint {
+    return {origin_.x + (point.x / zoom_), origin_.y + (point.y / zoom_)};
+  }
+
+  /// convert an area in map pixels to screen pixels
+  [[nodiscard]] auto mapToScreen(const SDL_FRect &rect) const noexcept
+      -> SDL_FRect {
+    return {(rect.x - origin_.x) * zoom_, (rect.y - origin_.y) * zoom_,
+            rect.w * zoom_, rect.h * zoom_};
+  }
+
+  /// get the area of the map visible in a window
+  ///
+  /// \param[in] WindowSize the window size in screen pixels
+  [[nodiscard]] auto visibleArea(const SDL_Point &windowSize) const noexcept
+      -> SDL_FRect {
+    return {origin_.x, origin_.y, static_cast<float>(windowSize.x) / zoom_,
+            static_cast<float>(windowSize.y) / zoom_};
+  }
+
+private:
+  static constexpr float minZoom{0.25};
+  static constexpr float maxZoom{4};
+
+  SDL_FPoint origin_{};
+  float zoom_{1};
+};
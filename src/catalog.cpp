@@ -0,0 +1,195 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <deque>
+#include <istream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+export module catalog;
+
+import actorStore;
+import sprite;
+import tile;
+import tileStore;
+
+/// registry of the tile, character and enemy kinds
+///
+/// every name is stored once, the kinds reference the interned names and the
+/// tiles of the levels reference the tile kinds by catalog id
+export class Catalog {
+public:
+  Catalog() = default;
+
+  /// the kinds reference the names of the catalog, a copy would reference
+  /// the names of the copied catalog
+  Catalog(const Catalog &) = delete;
+  /// moving keeps the names in place
+  Catalog(Catalog &&) = default;
+  auto operator=(const Catalog &) -> Catalog & = delete;
+  auto operator=(Catalog &&) -> Catalog & = default;
+  ~Catalog() = default;
+
+  /// add the kinds listed in a tileset index
+  ///
+  /// each line of the index is in the form:\n
+  /// KindType KindName x y w h\n
+  /// with KindType = (terrain|terrainA|character|enemy|enemyw), the lines of
+  /// other types are skipped
+  ///
+  /// \param[in] Istream the stream to read the index from
+  auto load(std::istream &istream) -> void;
+
+  /// remove every kind and name
+  auto clear() noexcept -> void;
+
+  /// store a name once
+  ///
+  /// \param[in] Name the name to store
+  /// \return a null terminated view of the stored name, valid until clear()
+  auto intern(std::string_view name) -> std::string_view;
+
+  /// add a tile kind
+  ///
+  /// \return the catalog id of the new kind
+  auto addTile(std::string_view name, bool animated,
+               const SDL_FRect &sourceRect) -> CatalogId;
+
+  /// add a playable character
+  auto addCharacter(std::string_view name, const SDL_FRect &sourceRect,
+                    bool canRun) -> void;
+
+  /// add an enemy
+  ///
+  /// \return the kind id of the new enemy
+  auto addEnemy(std::string_view name, const SDL_FRect &sourceRect,
+                bool canRun) -> ActorKindId;
+
+  /// find the first tile kind of a name
+  [[nodiscard]] auto findTile(std::string_view name) const noexcept
+      -> std::optional<CatalogId>;
+
+  /// find the first enemy kind of a name
+  [[nodiscard]] auto findEnemy(std::string_view name) const noexcept
+      -> std::optional<ActorKindId>;
+
+  /// get the tile kinds indexed by catalog id
+  [[nodiscard]] auto tiles() const noexcept
+      -> std::span<const RendererBuilder> {
+    return tiles_;
+  }
+
+  [[nodiscard]] auto tile(CatalogId catalogId) const noexcept
+      -> const RendererBuilder & {
+    return tiles_[catalogId];
+  }
+
+  [[nodiscard]] auto characters() const noexcept
+      -> std::span<const CharacterSprite> {
+    return characters_;
+  }
+
+  [[nodiscard]] auto enemies() const noexcept
+      -> std::span<const CharacterSprite> {
+    return enemies_;
+  }
+
+private:
+  /// the interned names, a deque never moves its elements when growing
+  std::deque<std::string> names_;
+  std::unordered_set<std::string_view> internedNames_;
+
+  std::vector<RendererBuilder> tiles_;
+  std::unordered_map<std::string_view, CatalogId> tileIds_;
+  std::vector<CharacterSprite> characters_;
+  std::vector<CharacterSprite> enemies_;
+  std::unordered_map<std::string_view, ActorKindId> enemyIds_;
+};
+
+auto Catalog::load(std::istream &istream) -> void {
+  while (istream && !istream.eof()) {
+    std::string kindType;
+    std::string kindName;
+    SDL_FRect sourceRect;
+    istream >> kindType >> kindName >> sourceRect.x >> sourceRect.y >>
+        sourceRect.w >> sourceRect.h;
+
+    if (kindType == "terrain") {
+      addTile(kindName, false, sourceRect);
+    } else if (kindType == "terrainA") {
+      addTile(kindName, true, sourceRect);
+    } else if (kindType == "character") {
+      addCharacter(kindName, sourceRect, true);
+    } else if (kindType == "enemy") {
+      addEnemy(kindName, sourceRect, true);
+    } else if (kindType == "enemyw") {
+      addEnemy(kindName, sourceRect, false);
+    } else {
+      istream.ignore();
+    }
+  }
+}
+
+auto Catalog::clear() noexcept -> void {
+  tiles_.clear();
+  tileIds_.clear();
+  characters_.clear();
+  enemies_.clear();
+  enemyIds_.clear();
+  internedNames_.clear();
+  names_.clear();
+}
+
+auto Catalog::intern(std::string_view name) -> std::string_view {
+  if (auto nameIt = internedNames_.find(name);
+      nameIt != internedNames_.end()) {
+    return *nameIt;
+  }
+  const std::string_view interned{names_.emplace_back(name)};
+  internedNames_.insert(interned);
+  return interned;
+}
+
+auto Catalog::addTile(std::string_view name, bool animated,
+                      const SDL_FRect &sourceRect) -> CatalogId {
+  const auto catalogId = static_cast<CatalogId>(tiles_.size());
+  const auto &kind = tiles_.emplace_back(intern(name), animated, sourceRect);
+  tileIds_.emplace(kind.name(), catalogId);
+  return catalogId;
+}
+
+auto Catalog::addCharacter(std::string_view name, const SDL_FRect &sourceRect,
+                           bool canRun) -> void {
+  characters_.emplace_back(intern(name), sourceRect, canRun, true);
+}
+
+auto Catalog::addEnemy(std::string_view name, const SDL_FRect &sourceRect,
+                       bool canRun) -> ActorKindId {
+  const auto kindId = static_cast<ActorKindId>(enemies_.size());
+  const auto &kind =
+      enemies_.emplace_back(intern(name), sourceRect, canRun, false);
+  enemyIds_.emplace(kind.name(), kindId);
+  return kindId;
+}
+
+auto Catalog::findTile(std::string_view name) const noexcept
+    -> std::optional<CatalogId> {
+  if (auto idIt = tileIds_.find(name); idIt != tileIds_.end()) {
+    return idIt->second;
+  }
+  return std::nullopt;
+}
+
+auto Catalog::findEnemy(std::string_view name) const noexcept
+    -> std::optional<ActorKindId> {
+  if (auto idIt = enemyIds_.find(name); idIt != enemyIds_.end()) {
+    return idIt->second;
+  }
+  return std::nullopt;
+}
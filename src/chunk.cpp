@@ -0,0 +1,260 @@
+module;
+
+#include "SDL3/SDL_pixels.h"
+#include "SDL3/SDL_rect.h"
+#include "SDL3/SDL_render.h"
+#include "SDL3/SDL_stdinc.h"
+#include "SDL3/SDL_timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module chunk;
+
+import grid;
+import sdlHelpers;
+import tileStore;
+
+/// the floor tiles of a chunk and their cached rendering
+struct Chunk {
+  /// the static tiles, rendered once into texture
+  std::vector<TileSlot> tiles;
+  /// the animated tiles and the ones larger than a cell, rendered every frame
+  /// on top of texture
+  std::vector<TileSlot> perFrame;
+  /// the static tiles rendering, created on the first bake
+  SdlTexturePtr texture{nullptr, SDL_DestroyTexture};
+  /// whether texture has to be rendered again
+  bool dirty{true};
+  /// the last render the chunk was visible in, see FloorChunks::render()
+  Uint64 lastVisible{};
+};
+
+/// floor tiles grouped by chunk, each chunk caching its static tiles in a
+/// texture
+///
+/// the tiles are owned by a TileStore, the chunks only reference their slots.
+/// Past the texture budget, the textures of the chunks away from the view are
+/// released, least recently visible first, and baked again when visible
+export class FloorChunks {
+public:
+  /// default number of chunk textures kept, each one takes 4 MB
+  static constexpr size_t defaultTextureBudget{64};
+
+  /// constructor
+  ///
+  /// \param[in] TextureBudget the number of chunk textures kept when the
+  /// chunks away from the view can release theirs
+  explicit FloorChunks(size_t textureBudget = defaultTextureBudget)
+      : textureBudget_{textureBudget} {}
+
+  /// add a tile to its chunk
+  ///
+  /// \param[in] Cell the cell of the tile
+  /// \param[in] Slot the slot of the tile in its store
+  /// \param[in] PerFrame whether the tile has to be rendered every frame,
+  /// see RendererBuilder::isBakeable()
+  auto insert(const Cell &cell, TileSlot slot, bool perFrame) -> void;
+
+  /// remove a tile from its chunk
+  auto erase(const Cell &cell, TileSlot slot) -> void;
+
+  /// remove every tile
+  auto clear() noexcept -> void {
+    chunks_.clear();
+    textureCount_ = 0;
+  }
+
+  /// get the number of chunks holding a texture
+  [[nodiscard]] auto textureCount() const noexcept -> size_t {
+    return textureCount_;
+  }
+
+  /// render the chunks visible in an area of the map
+  ///
+  /// dirty chunks are baked again until the bake budget is spent, the
+  /// remaining ones are rendered tile by tile and baked on a later frame
+  ///
+  /// \param[in] Renderer the renderer used to bake the chunks
+  /// \param[in] Batch the sprite batch to add the chunks to
+  /// \param[in] View the visible area in map pixels
+  /// \param[in] BakeBudget the time allowed to bake chunks in nanoseconds
+  /// \param[in] DrawTile called with a tile slot to add the tile to the batch
+  template <class DrawTile>
+  auto render(const SdlRenderer &renderer, SpriteBatch &batch,
+              const SDL_FRect &view, Uint64 bakeBudget, DrawTile &&drawTile)
+      -> void;
+
+private:
+  /// number of chunks around the visible ones keeping their texture
+  static constexpr int keptMargin{1};
+
+  /// render the static tiles of a chunk into its texture
+  template <class DrawTile>
+  auto bake(const SdlRenderer &renderer, SpriteBatch &batch,
+            const ChunkCoord &coord, Chunk &chunk, DrawTile &drawTile) -> void;
+
+  /// release the textures of the least recently visible chunks outside an
+  /// area until the texture budget is met
+  ///
+  /// \param[in] First the first chunk of the kept area
+  /// \param[in] Last the last chunk of the kept area
+  auto evict(const ChunkCoord &first, const ChunkCoord &last) -> void;
+
+  std::unordered_map<ChunkCoord, Chunk, GridHash> chunks_;
+
+  size_t textureBudget_;
+  size_t textureCount_{};
+  /// number of calls to render(), dates the last visible render of a chunk
+  Uint64 renderCount_{};
+
+  /// the chunks visible during the current render, kept to reuse its memory
+  std::vector<std::pair<ChunkCoord, Chunk *>> visible_;
+  /// the chunks whose texture can be released, kept to reuse its memory
+  std::vector<Chunk *> evictable_;
+};
+
+auto FloorChunks::insert(const Cell &cell, TileSlot slot, bool perFrame)
+    -> void {
+  auto &chunk = chunks_[chunkOf(cell)];
+  if (perFrame) {
+    chunk.perFrame.push_back(slot);
+  } else {
+    chunk.tiles.push_back(slot);
+    chunk.dirty = true;
+  }
+}
+
+auto FloorChunks::erase(const Cell &cell, TileSlot slot) -> void {
+  auto chunkIt = chunks_.find(chunkOf(cell));
+  if (chunkIt == chunks_.end()) {
+    return;
+  }
+
+  auto &chunk = chunkIt->second;
+  if (std::erase(chunk.tiles, slot) != 0) {
+    chunk.dirty = true;
+  }
+  std::erase(chunk.perFrame, slot);
+
+  if (chunk.tiles.empty() && chunk.perFrame.empty()) {
+    if (chunk.texture) {
+      --textureCount_;
+    }
+    chunks_.erase(chunkIt);
+  }
+}
+
+template <class DrawTile>
+auto FloorChunks::bake(const SdlRenderer &renderer, SpriteBatch &batch,
+                       const ChunkCoord &coord, Chunk &chunk,
+                       DrawTile &drawTile) -> void {
+  if (!chunk.texture) {
+    constexpr auto size = static_cast<int>(chunkPixels);
+    chunk.texture = renderer.createTargetTexture({size, size});
+    ++textureCount_;
+  }
+
+  batch.flush();
+  renderer.setRenderTarget(chunk.texture);
+  constexpr SDL_Color transparent{0, 0, 0, 0};
+  renderer.setRenderDrawColor(transparent);
+  renderer.renderClear();
+
+  const auto rect = chunkRect(coord);
+  const auto view = batch.getView();
+  batch.setView({.origin = {rect.x, rect.y}});
+  for (auto slot : chunk.tiles) {
+    drawTile(slot);
+  }
+  batch.flush();
+  batch.setView(view);
+
+  renderer.resetRenderTarget();
+  chunk.dirty = false;
+}
+
+template <class DrawTile>
+auto FloorChunks::render(const SdlRenderer &renderer, SpriteBatch &batch,
+                         const SDL_FRect &view, Uint64 bakeBudget,
+                         DrawTile &&drawTile) -> void {
+  const auto first = chunkAt({view.x, view.y});
+  const auto last = chunkAt({view.x + view.w, view.y + view.h});
+
+  ++renderCount_;
+  visible_.clear();
+  for (int chunkY = first.y; chunkY <= last.y; ++chunkY) {
+    for (int chunkX = first.x; chunkX <= last.x; ++chunkX) {
+      const ChunkCoord coord{.x = chunkX, .y = chunkY};
+      if (auto chunkIt = chunks_.find(coord); chunkIt != chunks_.end()) {
+        chunkIt->second.lastVisible = renderCount_;
+        visible_.emplace_back(coord, &chunkIt->second);
+      }
+    }
+  }
+
+  // always bake at least one chunk so the cache catches up eventually
+  const auto deadline = SDL_GetTicksNS() + bakeBudget;
+  bool baked{};
+  for (auto &[coord, chunk] : visible_) {
+    if (chunk->dirty && (!baked || SDL_GetTicksNS() < deadline)) {
+      bake(renderer, batch, coord, *chunk, drawTile);
+      baked = true;
+    }
+  }
+
+  constexpr SDL_FRect chunkSource{0, 0, chunkPixels, chunkPixels};
+  for (auto &[coord, chunk] : visible_) {
+    if (chunk->dirty) {
+      for (auto slot : chunk->tiles) {
+        drawTile(slot);
+      }
+    } else {
+      batch.addQuad(chunk->texture, chunkSource, chunkRect(coord));
+    }
+  }
+
+  // the tiles larger than a cell reach up and right of it, into the view
+  // from the chunks left of and below it
+  for (int chunkY = first.y; chunkY <= last.y + 1; ++chunkY) {
+    for (int chunkX = first.x - 1; chunkX <= last.x; ++chunkX) {
+      if (auto chunkIt = chunks_.find({.x = chunkX, .y = chunkY});
+          chunkIt != chunks_.end()) {
+        for (auto slot : chunkIt->second.perFrame) {
+          drawTile(slot);
+        }
+      }
+    }
+  }
+
+  if (textureCount_ > textureBudget_) {
+    evict({.x = first.x - keptMargin, .y = first.y - keptMargin},
+          {.x = last.x + keptMargin, .y = last.y + keptMargin});
+  }
+}
+
+auto FloorChunks::evict(const ChunkCoord &first, const ChunkCoord &last)
+    -> void {
+  evictable_.clear();
+  for (auto &[coord, chunk] : chunks_) {
+    if (chunk.texture && (coord.x < first.x || coord.x > last.x ||
+                          coord.y < first.y || coord.y > last.y)) {
+      evictable_.push_back(&chunk);
+    }
+  }
+
+  const auto count =
+      std::min(textureCount_ - textureBudget_, evictable_.size());
+  std::ranges::partial_sort(
+      evictable_, evictable_.begin() + static_cast<std::ptrdiff_t>(count), {},
+      &Chunk::lastVisible);
+  for (size_t index = 0; index < count; ++index) {
+    evictable_[index]->texture.reset();
+    evictable_[index]->dirty = true;
+  }
+  textureCount_ -= count;
+}
@@ -0,0 +1,295 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+export module editHistory;
+
+import editor;
+import grid;
+import tileStore;
+
+/// cells of a row changed from the same tile to the same tile
+export struct DeltaRun {
+  /// flag set when the previous tiles were in the air
+  static constexpr std::uint8_t oldLevelFlag{1U << 0U};
+  /// flag set when the new tiles are in the air
+  static constexpr std::uint8_t newLevelFlag{1U << 1U};
+
+  /// the leftmost cell, packed by packCell()
+  std::uint32_t cell;
+  /// number of cells of the run, to the right of cell
+  std::uint16_t length;
+  /// the previous tile kind, TileStore::freeId for no tile
+  CatalogId oldId;
+  /// the new tile kind, TileStore::freeId for no tile
+  CatalogId newId;
+  std::uint8_t flags;
+};
+
+/// undo and redo history of the editor
+///
+/// the changes of a stroke are recorded as a group of run length encoded
+/// deltas, so undoing a fill of a million cells costs its changed cells and
+/// stores a run per row. The oldest groups are forgotten past a memory cap
+export class EditHistory {
+public:
+  /// default memory cap, in bytes
+  static constexpr std::size_t defaultMemoryCap{16U << 20U};
+
+  /// constructor
+  ///
+  /// \param[in] MemoryCap the most memory used by the recorded groups
+  explicit EditHistory(std::size_t memoryCap = defaultMemoryCap)
+      : memoryCap_{memoryCap} {}
+
+  /// start a group, the changes recorded until endGroup() are undone
+  /// together
+  ///
+  /// \param[in] Wall whether the changes of the group are in the wall layer
+  auto beginGroup(bool wall) -> void {
+    recording_ = true;
+    recordingWall_ = wall;
+    changes_.clear();
+  }
+
+  /// check if a group is recorded
+  [[nodiscard]] auto isRecording() const noexcept -> bool {
+    return recording_;
+  }
+
+  /// record the change of the tile of a cell in the current group
+  ///
+  /// \param[in] Cell the changed cell
+  /// \param[in] OldId the previous tile kind, TileStore::freeId for no tile
+  /// \param[in] OldLevel whether the previous tile was in the air
+  /// \param[in] NewId the new tile kind, TileStore::freeId for no tile
+  /// \param[in] NewLevel whether the new tile is in the air
+  auto record(const Cell &cell, CatalogId oldId, bool oldLevel,
+              CatalogId newId, bool newLevel) -> void;
+
+  /// end the current group, dropping the redo history if it changed
+  /// anything
+  auto endGroup() -> void;
+
+  [[nodiscard]] auto canUndo() const noexcept -> bool {
+    return undoCount_ > 0;
+  }
+  [[nodiscard]] auto canRedo() const noexcept -> bool {
+    return undoCount_ < groups_.size();
+  }
+
+  /// get the edits undoing the last group
+  ///
+  /// \param[out] Edits the edits to apply, replaced
+  /// \return whether the edits apply to the wall layer, empty if there is
+  /// nothing to undo
+  auto undo(std::vector<TileEdit> &edits) -> std::optional<bool>;
+
+  /// get the edits redoing the last undone group
+  ///
+  /// \param[out] Edits the edits to apply, replaced
+  /// \return whether the edits apply to the wall layer, empty if there is
+  /// nothing to redo
+  auto redo(std::vector<TileEdit> &edits) -> std::optional<bool>;
+
+  /// forget every group, when the level is replaced
+  auto clear() noexcept -> void {
+    runs_.clear();
+    groups_.clear();
+    undoCount_ = 0;
+    recording_ = false;
+    changes_.clear();
+  }
+
+  /// set the most memory used by the recorded groups, forgetting the oldest
+  /// ones past it
+  auto setMemoryCap(std::size_t memoryCap) -> void {
+    memoryCap_ = memoryCap;
+    enforceMemoryCap();
+  }
+
+  /// get the memory used by the recorded groups, in bytes
+  [[nodiscard]] auto memoryUsage() const noexcept -> std::size_t {
+    return (runs_.size() * sizeof(DeltaRun)) +
+           (groups_.size() * sizeof(Group));
+  }
+
+private:
+  /// a change recorded in the current group
+  struct Change {
+    Cell cell;
+    CatalogId oldId;
+    bool oldLevel;
+    CatalogId newId;
+    bool newLevel;
+  };
+
+  /// the runs of a stroke
+  struct Group {
+    /// whether the runs are in the wall layer
+    bool wall;
+    std::size_t runCount;
+  };
+
+  /// get the edits of a group, from the previous tiles or to the new ones
+  auto expand(std::size_t group, bool undo, std::vector<TileEdit> &edits) const
+      -> void;
+
+  /// forget the oldest groups until the memory cap is met
+  auto enforceMemoryCap() -> void;
+
+  std::size_t memoryCap_;
+
+  /// the runs of every group, oldest first
+  std::deque<DeltaRun> runs_;
+  /// the groups, oldest first, the ones past undoCount_ can be redone
+  std::deque<Group> groups_;
+  /// number of groups that can be undone
+  std::size_t undoCount_{};
+
+  bool recording_{};
+  bool recordingWall_{};
+  /// the changes of the current group, compressed in runs by endGroup()
+  std::vector<Change> changes_;
+};
+
+auto EditHistory::record(const Cell &cell, CatalogId oldId, bool oldLevel,
+                         CatalogId newId, bool newLevel) -> void {
+  if (recording_) {
+    changes_.push_back({.cell = cell,
+                        .oldId = oldId,
+                        .oldLevel = oldLevel,
+                        .newId = newId,
+                        .newLevel = newLevel});
+  }
+}
+
+auto EditHistory::endGroup() -> void {
+  recording_ = false;
+  if (changes_.empty()) {
+    return;
+  }
+
+  // the groups past undoCount_ were undone, a new change makes them
+  // unreachable
+  std::size_t redoRuns{};
+  for (auto group = undoCount_; group < groups_.size(); ++group) {
+    redoRuns += groups_[group].runCount;
+  }
+  runs_.resize(runs_.size() - redoRuns);
+  groups_.resize(undoCount_);
+
+  // sort the changes by row so the neighbouring cells form runs, a cell
+  // changed twice keeps its first previous tile and its last new one
+  std::ranges::stable_sort(changes_, [](const Change &lhs, const Change &rhs) {
+    return std::tie(lhs.cell.y, lhs.cell.x) < std::tie(rhs.cell.y, rhs.cell.x);
+  });
+
+  const auto firstRun = runs_.size();
+  for (auto change = changes_.begin(); change != changes_.end();) {
+    auto last = change;
+    while (std::next(last) != changes_.end() &&
+           std::next(last)->cell == change->cell) {
+      ++last;
+    }
+    const auto oldId = change->oldId;
+    const auto oldLevel = change->oldLevel;
+    const auto newId = last->newId;
+    const auto newLevel = last->newLevel;
+    const auto cell = change->cell;
+    change = std::next(last);
+
+    const auto flags =
+        static_cast<std::uint8_t>((oldLevel ? DeltaRun::oldLevelFlag : 0U) |
+                                  (newLevel ? DeltaRun::newLevelFlag : 0U));
+    if (runs_.size() > firstRun) {
+      auto &run = runs_.back();
+      const auto runCell = unpackCell(run.cell);
+      if (runCell.y == cell.y && runCell.x + run.length == cell.x &&
+          run.oldId == oldId && run.newId == newId && run.flags == flags &&
+          run.length < std::numeric_limits<std::uint16_t>::max()) {
+        ++run.length;
+        continue;
+      }
+    }
+    runs_.push_back({.cell = packCell(cell),
+                     .length = 1,
+                     .oldId = oldId,
+                     .newId = newId,
+                     .flags = flags});
+  }
+  changes_.clear();
+
+  groups_.push_back(
+      {.wall = recordingWall_, .runCount = runs_.size() - firstRun});
+  undoCount_ = groups_.size();
+  enforceMemoryCap();
+}
+
+auto EditHistory::undo(std::vector<TileEdit> &edits)
+    -> std::optional<bool> {
+  if (!canUndo()) {
+    return std::nullopt;
+  }
+  --undoCount_;
+  expand(undoCount_, true, edits);
+  return groups_[undoCount_].wall;
+}
+
+auto EditHistory::redo(std::vector<TileEdit> &edits)
+    -> std::optional<bool> {
+  if (!canRedo()) {
+    return std::nullopt;
+  }
+  expand(undoCount_, false, edits);
+  return groups_[undoCount_++].wall;
+}
+
+auto EditHistory::expand(std::size_t group, bool undo,
+                         std::vector<TileEdit> &edits) const -> void {
+  // the undone and redone groups are the last ones, count from the end
+  auto lastRun = runs_.size();
+  for (auto index = groups_.size() - 1; index > group; --index) {
+    lastRun -= groups_[index].runCount;
+  }
+  const auto firstRun = lastRun - groups_[group].runCount;
+
+  edits.clear();
+  for (auto run = firstRun; run < lastRun; ++run) {
+    const auto &delta = runs_[run];
+    const auto catalogId = undo ? delta.oldId : delta.newId;
+    const auto level =
+        (delta.flags &
+         (undo ? DeltaRun::oldLevelFlag : DeltaRun::newLevelFlag)) != 0;
+    auto cell = unpackCell(delta.cell);
+    for (std::uint16_t offset = 0; offset < delta.length; ++offset) {
+      edits.push_back({.cell = cell, .catalogId = catalogId, .level = level});
+      ++cell.x;
+    }
+  }
+}
+
+auto EditHistory::enforceMemoryCap() -> void {
+  while (!groups_.empty() && memoryUsage() > memoryCap_) {
+    if (undoCount_ == 0) {
+      // the oldest group can only be redone, the next ones can not be
+      // redone without it
+      runs_.clear();
+      groups_.clear();
+      return;
+    }
+    runs_.erase(runs_.begin(),
+                runs_.begin() +
+                    static_cast<std::ptrdiff_t>(groups_.front().runCount));
+    groups_.pop_front();
+    --undoCount_;
+  }
+}
@@ -0,0 +1,249 @@
+module;
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+export module editJournal;
+
+import catalog;
+import grid;
+import levelBinary;
+import mappedFile;
+import profiler;
+import tile;
+import tileStore;
+
+/// first bytes of an edit journal file
+export constexpr std::array<char, 4> journalMagic{'L', 'V', 'L', 'J'};
+/// version of the edit journal format
+export constexpr std::uint16_t journalVersion{1};
+
+/// header of an edit journal file
+///
+/// the file is laid out as:\n
+/// header, catalog entries, catalog names padded to 8 bytes, edit records\n
+/// the catalog maps the catalog ids of the records to tile kind names, the
+/// records are appended as the level is edited
+export struct JournalHeader {
+  std::array<char, 4> magic;
+  std::uint16_t version;
+  /// size of the header in bytes
+  std::uint16_t headerSize;
+  std::uint32_t catalogCount;
+  /// size of the catalog names in bytes, without the padding
+  std::uint32_t namesSize;
+};
+
+/// an edit of a level
+export struct JournalRecord {
+  /// flag set on the records of the wall layer
+  static constexpr std::uint8_t wallFlag{1U << 0U};
+  /// flag set on the records placing a tile in the air
+  static constexpr std::uint8_t levelFlag{1U << 1U};
+  /// flag set on the records erasing a tile, the others place one
+  static constexpr std::uint8_t eraseFlag{1U << 2U};
+
+  /// the edited cell packed by packCell(), one of the storableCells
+  std::uint32_t cell;
+  /// index of the placed tile kind in the catalog entries of the file
+  std::uint16_t catalogId;
+  std::uint8_t flags;
+  std::uint8_t reserved;
+};
+
+static_assert(sizeof(JournalHeader) == 16);
+static_assert(sizeof(JournalRecord) == 8);
+static_assert(std::is_trivially_copyable_v<JournalHeader> &&
+              std::is_trivially_copyable_v<JournalRecord>);
+
+/// append only journal of the edits made to a level since it was saved
+///
+/// the edits are buffered and appended by flush(), once a frame. Replaying a
+/// journal on a level already containing some of its edits gives the same
+/// level, each record sets the final state of its cell
+export class EditJournal {
+public:
+  /// constructor
+  ///
+  /// \param[in] Path the path of the journal, the file is created by the
+  /// first flush() with edits
+  explicit EditJournal(std::filesystem::path path) : path_{std::move(path)} {}
+
+  /// record a tile placed in a cell, replacing the previous one
+  auto place(bool wall, const Cell &cell, CatalogId catalogId, bool level)
+      -> void {
+    pending_.push_back(
+        {.cell = packCell(cell),
+         .catalogId = catalogId,
+         .flags = static_cast<std::uint8_t>(
+             (wall ? JournalRecord::wallFlag : 0U) |
+             (level ? JournalRecord::levelFlag : 0U)),
+         .reserved = 0});
+  }
+
+  /// record the tile of a cell erased
+  auto erase(bool wall, const Cell &cell) -> void {
+    pending_.push_back(
+        {.cell = packCell(cell),
+         .catalogId = 0,
+         .flags = static_cast<std::uint8_t>(
+             JournalRecord::eraseFlag | (wall ? JournalRecord::wallFlag : 0U)),
+         .reserved = 0});
+  }
+
+  /// append the recorded edits to the journal file
+  ///
+  /// \param[in] Catalog the tile kinds indexed by catalog id, written in the
+  /// header when the file is created
+  auto flush(std::span<const RendererBuilder> catalog) -> void;
+
+  /// get the number of edits recorded since the journal was created or
+  /// rotated
+  [[nodiscard]] auto size() const noexcept -> size_t {
+    return flushed_ + pending_.size();
+  }
+
+  /// move the journal file aside to start an empty journal
+  ///
+  /// \param[in] Path the new path of the current journal file
+  /// \return false if there was no journal file to move
+  auto rotate(const std::filesystem::path &path) -> bool;
+
+  [[nodiscard]] auto getPath() const noexcept
+      -> const std::filesystem::path & {
+    return path_;
+  }
+
+private:
+  std::filesystem::path path_;
+  std::ofstream file_;
+  std::vector<JournalRecord> pending_;
+  size_t flushed_{};
+};
+
+auto EditJournal::flush(std::span<const RendererBuilder> catalog) -> void {
+  if (pending_.empty()) {
+    return;
+  }
+  const ProfileZone zone{"EditJournal::flush"};
+
+  const auto write = [this](const auto *data, std::size_t size) {
+    file_.write(reinterpret_cast<const char *>(data),
+                static_cast<std::streamsize>(size));
+  };
+
+  if (!file_.is_open()) {
+    auto size = std::filesystem::exists(path_)
+                    ? std::filesystem::file_size(path_)
+                    : std::uintmax_t{};
+    if (size != 0) {
+      // every part of the file is a multiple of a record, drop the record cut
+      // by a crash so the appended ones stay aligned
+      size -= size % sizeof(JournalRecord);
+      std::filesystem::resize_file(path_, size);
+    }
+    file_.open(path_, std::ios::binary | std::ios::app);
+    if (size == 0) {
+      const JournalHeader header{
+          .magic = journalMagic,
+          .version = journalVersion,
+          .headerSize = sizeof(JournalHeader),
+          .catalogCount = static_cast<std::uint32_t>(catalog.size()),
+          .namesSize = catalogNamesSize(catalog)};
+      write(&header, sizeof(header));
+      writeCatalogTable(file_, catalog);
+    }
+  }
+
+  write(pending_.data(), pending_.size() * sizeof(JournalRecord));
+  file_.flush();
+  flushed_ += pending_.size();
+  pending_.clear();
+}
+
+auto EditJournal::rotate(const std::filesystem::path &path) -> bool {
+  file_.close();
+  flushed_ = 0;
+  if (!std::filesystem::exists(path_)) {
+    return false;
+  }
+  std::filesystem::rename(path_, path);
+  return true;
+}
+
+/// apply the edits of a journal file to a level
+///
+/// a missing journal is an empty one, a record cut by a crash at the end of
+/// the file is ignored, like the records outside the storableCells
+///
+/// \param[in] Path the path of the journal
+/// \param[in] Catalog the catalog to look the tile names up in
+/// \param[in,out] Map the floor layer
+/// \param[in,out] MapWall the wall layer
+/// \return the number of edits applied
+/// \throw LevelFormatError if the file is not an edit journal
+export auto replayJournal(const std::filesystem::path &path,
+                          const Catalog &catalog, TileStore &map,
+                          TileStore &mapWall) -> size_t {
+  if (!std::filesystem::exists(path)) {
+    return 0;
+  }
+  const ProfileZone zone{"replayJournal"};
+
+  const MappedFile file{path};
+  const auto bytes = file.bytes();
+  if (bytes.empty()) {
+    return 0;
+  }
+  if (bytes.size() < sizeof(JournalHeader)) {
+    throw LevelFormatError{
+        std::format("{} is not an edit journal", path.string())};
+  }
+  const auto *header = reinterpret_cast<const JournalHeader *>(bytes.data());
+  if (header->magic != journalMagic || header->version != journalVersion ||
+      header->headerSize < sizeof(JournalHeader) ||
+      header->headerSize % sizeof(JournalRecord) != 0) {
+    throw LevelFormatError{
+        std::format("{} is not an edit journal", path.string())};
+  }
+
+  const auto table = readCatalogTable(bytes, header->headerSize,
+                                      header->catalogCount, header->namesSize);
+  if (!table) {
+    throw LevelFormatError{
+        std::format("{} has a truncated or bad catalog", path.string())};
+  }
+  const std::span records{
+      reinterpret_cast<const JournalRecord *>(bytes.data() + table->end),
+      (bytes.size() - table->end) / sizeof(JournalRecord)};
+  const auto fileIds = table->matchTiles(catalog);
+
+  for (const auto &record : records) {
+    auto &store = (record.flags & JournalRecord::wallFlag) != 0 ? mapWall : map;
+    const auto cell = unpackCell(record.cell);
+    if (!storableCells.contains(cell)) {
+      continue;
+    }
+    if (auto slot = store.find(cell)) {
+      store.erase(*slot);
+    }
+    if ((record.flags & JournalRecord::eraseFlag) != 0 ||
+        record.catalogId >= fileIds.size() ||
+        fileIds[record.catalogId] == unknownCatalogId) {
+      continue;
+    }
+    store.insert(cell, fileIds[record.catalogId],
+                 (record.flags & JournalRecord::levelFlag) != 0);
+  }
+  return records.size();
+}
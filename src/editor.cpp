@@ -0,0 +1,177 @@
+module;
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+export module editor;
+
+import grid;
+import tileStore;
+
+/// the ways the editor changes the tiles under the mouse
+export enum class EditorTool : std::uint8_t {
+  /// change the cells the mouse is dragged over
+  paint,
+  /// change the cells of the rectangle between the press and the release
+  rectangle,
+  /// change the cells connected to the pressed one holding the same tile
+  fill,
+  /// place or erase enemies in the cells the mouse is dragged over
+  enemy
+};
+
+/// a change of the tile of a cell
+export struct TileEdit {
+  Cell cell;
+  /// the new tile kind, TileStore::freeId to erase the tile
+  CatalogId catalogId;
+  /// whether the new tile is on the ground or in the air
+  bool level;
+};
+
+/// the cells a mouse press, drag and release applies a tool to
+///
+/// the stroke only collects cells, the edits are applied in one batch once
+/// the mouse is released. The cells are clamped to the storableCells, the
+/// camera can show cells a level can not hold
+export class EditStroke {
+public:
+  /// start a stroke at a cell
+  ///
+  /// \param[in] Tool the tool of the stroke
+  /// \param[in] Erase whether the stroke erases the tiles or places them
+  /// \param[in] Cell the pressed cell
+  auto begin(EditorTool tool, bool erase, const Cell &cell) -> void {
+    tool_ = tool;
+    erase_ = erase;
+    active_ = true;
+    anchor_ = storableCells.clamp(cell);
+    cursor_ = anchor_;
+    cells_.clear();
+    visited_.clear();
+    if (collectsCells()) {
+      add(anchor_);
+    }
+  }
+
+  /// move the stroke to a cell
+  ///
+  /// a paint or enemy stroke adds every cell between the previous cell and
+  /// the new one, so a fast drag leaves no gap
+  auto moveTo(const Cell &target) -> void {
+    const auto cell = storableCells.clamp(target);
+    if (!active_ || cell == cursor_) {
+      return;
+    }
+    if (collectsCells()) {
+      forEachLineCell(cursor_, cell, [this](const Cell &lineCell) {
+        add(lineCell);
+      });
+    }
+    cursor_ = cell;
+  }
+
+  /// stop the stroke and forget its cells
+  auto end() noexcept -> void {
+    active_ = false;
+    cells_.clear();
+    visited_.clear();
+  }
+
+  [[nodiscard]] auto isActive() const noexcept -> bool { return active_; }
+  [[nodiscard]] auto getTool() const noexcept -> EditorTool { return tool_; }
+  [[nodiscard]] auto isErase() const noexcept -> bool { return erase_; }
+
+  /// get the pressed cell
+  [[nodiscard]] auto getAnchor() const noexcept -> const Cell & {
+    return anchor_;
+  }
+
+  /// get the cells dragged over by a paint or enemy stroke, each once
+  [[nodiscard]] auto cells() const noexcept -> std::span<const Cell> {
+    return cells_;
+  }
+
+  /// get the area between the pressed cell and the current one
+  [[nodiscard]] auto area() const noexcept -> CellArea {
+    return CellArea::between(anchor_, cursor_);
+  }
+
+private:
+  /// check if the tool applies to the dragged over cells
+  [[nodiscard]] auto collectsCells() const noexcept -> bool {
+    return tool_ == EditorTool::paint || tool_ == EditorTool::enemy;
+  }
+
+  auto add(const Cell &cell) -> void {
+    if (visited_.insert(packCell(cell)).second) {
+      cells_.push_back(cell);
+    }
+  }
+
+  EditorTool tool_{EditorTool::paint};
+  bool erase_{};
+  bool active_{};
+  Cell anchor_{};
+  Cell cursor_{};
+  std::vector<Cell> cells_;
+  /// the packed cells of cells_
+  std::unordered_set<std::uint32_t> visited_;
+};
+
+/// call a visitor with the cells connected to a cell by their sides holding
+/// the same tile kind, or no tile
+///
+/// \param[in] Store the layer to fill
+/// \param[in] Start the first cell of the region
+/// \param[in] Area the area the region is limited to, along with the
+/// storableCells, a region of empty cells has no other limit
+/// \param[in] Visitor called once with each cell of the region
+export template <class Visitor>
+auto floodFill(const TileStore &store, const Cell &start, const CellArea &area,
+               Visitor &&visitor) -> void {
+  const CellArea bounds{.first = storableCells.clamp(area.first),
+                        .last = storableCells.clamp(area.last)};
+  if (!bounds.contains(start)) {
+    return;
+  }
+  const auto kindOf = [&store](const Cell &cell) {
+    const auto slot = store.find(cell);
+    return slot ? store.catalogId(*slot) : TileStore::freeId;
+  };
+  const auto kind = kindOf(start);
+
+  const auto width = static_cast<std::size_t>(bounds.width());
+  std::vector<bool> visited(width * static_cast<std::size_t>(bounds.height()));
+  const auto markVisited = [&](const Cell &cell) {
+    const auto index =
+        (static_cast<std::size_t>(cell.y - bounds.first.y) * width) +
+        static_cast<std::size_t>(cell.x - bounds.first.x);
+    if (visited[index]) {
+      return false;
+    }
+    visited[index] = true;
+    return true;
+  };
+
+  std::vector<Cell> pending{start};
+  markVisited(start);
+  while (!pending.empty()) {
+    const auto cell = pending.back();
+    pending.pop_back();
+    visitor(cell);
+
+    for (const Cell neighbour : {Cell{.x = cell.x - 1, .y = cell.y},
+                                 Cell{.x = cell.x + 1, .y = cell.y},
+                                 Cell{.x = cell.x, .y = cell.y - 1},
+                                 Cell{.x = cell.x, .y = cell.y + 1}}) {
+      if (bounds.contains(neighbour) && kindOf(neighbour) == kind &&
+          markVisited(neighbour)) {
+        pending.push_back(neighbour);
+      }
+    }
+  }
+}
@@ -0,0 +1,130 @@
+module;
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+export module frameScheduler;
+
+/// pace the frames at a target rate
+///
+/// the scheduler sleeps until shortly before the deadline of the next frame
+/// then spins for the remaining time, so the process does not keep a core
+/// busy between frames while still starting them on time
+export class FrameScheduler {
+public:
+  /// time source in nanoseconds
+  using Clock = std::function<Uint64()>;
+  /// sleep for a duration in nanoseconds
+  using Sleep = std::function<void(Uint64)>;
+
+  /// number of frame intervals used to compute the jitter
+  static constexpr size_t jitterWindow{120};
+
+  /// constructor
+  ///
+  /// \param[in] TargetRate the number of frames per second
+  /// \param[in] Clock the time source, SDL_GetTicksNS when empty
+  /// \param[in] Sleep the sleep function, SDL_DelayNS when empty
+  explicit FrameScheduler(Uint32 targetRate, Clock clock = {},
+                          Sleep sleep = {})
+      : clock_{clock ? std::move(clock) : Clock{SDL_GetTicksNS}},
+        sleep_{sleep ? std::move(sleep) : Sleep{SDL_DelayNS}} {
+    setTargetRate(targetRate);
+  }
+
+  /// change the number of frames per second
+  auto setTargetRate(Uint32 targetRate) noexcept -> void {
+    targetRate_ = std::max<Uint32>(targetRate, 1);
+    period_ = SDL_NS_PER_SECOND / targetRate_;
+  }
+
+  [[nodiscard]] auto getTargetRate() const noexcept -> Uint32 {
+    return targetRate_;
+  }
+
+  /// wait for the deadline of the next frame
+  ///
+  /// a late frame moves the following deadlines instead of rushing frames to
+  /// catch up
+  ///
+  /// \return the time since the start of the previous frame in nanoseconds
+  auto waitNextFrame() -> Uint64;
+
+  /// get the time the current frame started at in nanoseconds
+  [[nodiscard]] auto getFrameStart() const noexcept -> Uint64 {
+    return frameStart_;
+  }
+
+  /// get the mean distance between the frame intervals and the target period
+  /// over the last jitterWindow frames, in nanoseconds
+  [[nodiscard]] auto getJitter() const noexcept -> Uint64;
+
+  /// get the largest distance between a frame interval and the target period
+  /// over the last jitterWindow frames, in nanoseconds
+  [[nodiscard]] auto getMaxJitter() const noexcept -> Uint64 {
+    return *std::ranges::max_element(deviations_);
+  }
+
+private:
+  /// time left to the deadline under which the scheduler spins instead of
+  /// sleeping, the sleep of the OS is not precise enough below that
+  static constexpr Uint64 spinTail{SDL_NS_PER_MS / 2};
+
+  Clock clock_;
+  Sleep sleep_;
+
+  Uint32 targetRate_{};
+  Uint64 period_{};
+  Uint64 deadline_{};
+  Uint64 frameStart_{};
+  bool started_{};
+
+  std::array<Uint64, jitterWindow> deviations_{};
+  size_t deviationIndex_{};
+  size_t deviationCount_{};
+};
+
+auto FrameScheduler::waitNextFrame() -> Uint64 {
+  auto now = clock_();
+  if (!started_) {
+    started_ = true;
+    frameStart_ = now;
+    deadline_ = now + period_;
+    return 0;
+  }
+
+  if (now < deadline_ && deadline_ - now > spinTail) {
+    sleep_(deadline_ - now - spinTail);
+  }
+  while ((now = clock_()) < deadline_) {
+  }
+
+  const auto interval = now - frameStart_;
+  frameStart_ = now;
+  // keep the pace when on time, restart it from now after a late frame
+  deadline_ = now - deadline_ < period_ ? deadline_ + period_ : now + period_;
+
+  deviations_[deviationIndex_] =
+      interval > period_ ? interval - period_ : period_ - interval;
+  deviationIndex_ = (deviationIndex_ + 1) % jitterWindow;
+  deviationCount_ = std::min(deviationCount_ + 1, jitterWindow);
+
+  return interval;
+}
+
+auto FrameScheduler::getJitter() const noexcept -> Uint64 {
+  if (deviationCount_ == 0) {
+    return 0;
+  }
+  Uint64 total{};
+  for (size_t index = 0; index < deviationCount_; ++index) {
+    total += deviations_[index];
+  }
+  return total / deviationCount_;
+}
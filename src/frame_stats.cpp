@@ -0,0 +1,146 @@
+module;
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+export module frameStats;
+
+/// the parts a frame is split into
+export enum class FramePhase : std::uint8_t {
+  events,
+  simulation,
+  render,
+  gui,
+  present,
+};
+
+/// number of FramePhase values
+export constexpr size_t framePhaseCount{5};
+
+/// get the name of a frame phase to display it
+export constexpr auto framePhaseName(FramePhase phase) noexcept
+    -> std::string_view {
+  constexpr std::array<std::string_view, framePhaseCount> names{
+      "events", "sim", "render submit", "imgui", "present"};
+  return names[static_cast<size_t>(phase)];
+}
+
+/// rolling history of the frame durations and of the time spent in each
+/// phase of a frame
+export class FrameStats {
+public:
+  /// number of frames kept in the history
+  static constexpr size_t historySize{240};
+
+  /// percentiles of the frame durations of the history, in milliseconds
+  struct Percentiles {
+    float p50;
+    float p95;
+    float p99;
+    float max;
+  };
+
+  /// start recording a frame
+  ///
+  /// \param[in] Duration the time since the start of the previous frame in
+  /// nanoseconds
+  auto beginFrame(Uint64 duration) noexcept -> void {
+    current_ = {};
+    currentDuration_ = toMs(duration);
+  }
+
+  /// add time spent in a phase of the current frame
+  ///
+  /// \param[in] Phase the phase of the frame
+  /// \param[in] Duration the time spent in nanoseconds
+  auto addPhase(FramePhase phase, Uint64 duration) noexcept -> void {
+    current_[static_cast<size_t>(phase)] += toMs(duration);
+  }
+
+  /// add the current frame to the history
+  auto endFrame() noexcept -> void {
+    durations_[next_] = currentDuration_;
+    phases_[next_] = current_;
+    next_ = (next_ + 1) % historySize;
+    count_ = std::min(count_ + 1, historySize);
+  }
+
+  /// get the frame durations in milliseconds, oldest first starting at
+  /// getHistoryOffset() and wrapping around
+  [[nodiscard]] auto getHistory() const noexcept
+      -> const std::array<float, historySize> & {
+    return durations_;
+  }
+
+  /// get the index of the oldest frame duration of the history
+  [[nodiscard]] auto getHistoryOffset() const noexcept -> size_t {
+    return count_ < historySize ? 0 : next_;
+  }
+
+  /// get the number of frames in the history
+  [[nodiscard]] auto size() const noexcept -> size_t { return count_; }
+
+  /// get the percentiles of the frame durations of the history
+  [[nodiscard]] auto getPercentiles() const noexcept -> Percentiles;
+
+  /// get the mean time spent in a phase over the history, in milliseconds
+  [[nodiscard]] auto getPhaseMean(FramePhase phase) const noexcept -> float;
+
+private:
+  static constexpr auto toMs(Uint64 duration) noexcept -> float {
+    constexpr float nsPerMs{1'000'000};
+    return static_cast<float>(duration) / nsPerMs;
+  }
+
+  std::array<float, historySize> durations_{};
+  std::array<std::array<float, framePhaseCount>, historySize> phases_{};
+  std::array<float, framePhaseCount> current_{};
+  float currentDuration_{};
+  size_t next_{};
+  size_t count_{};
+
+  /// scratch copy of the durations partially sorted by getPercentiles()
+  mutable std::array<float, historySize> sorted_{};
+};
+
+auto FrameStats::getPercentiles() const noexcept -> Percentiles {
+  if (count_ == 0) {
+    return {};
+  }
+
+  const auto sorted = std::span{sorted_}.first(count_);
+  std::ranges::copy(std::span{durations_}.first(count_), sorted.begin());
+
+  // each nth_element leaves the greater values after the nth one, so the
+  // next, greater percentile only has to look there
+  const auto percentile = [&](auto first, size_t percent) {
+    const auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(
+                                          (count_ - 1) * percent / 100);
+    std::nth_element(first, nth, sorted.end());
+    return nth;
+  };
+  const auto p50 = percentile(sorted.begin(), 50);
+  const auto p95 = percentile(p50, 95);
+  const auto p99 = percentile(p95, 99);
+  return {.p50 = *p50,
+          .p95 = *p95,
+          .p99 = *p99,
+          .max = *std::max_element(p99, sorted.end())};
+}
+
+auto FrameStats::getPhaseMean(FramePhase phase) const noexcept -> float {
+  if (count_ == 0) {
+    return 0;
+  }
+  float total{};
+  for (size_t index = 0; index < count_; ++index) {
+    total += phases_[index][static_cast<size_t>(phase)];
+  }
+  return total / static_cast<float>(count_);
+}
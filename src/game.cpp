@@ -17,20 +17,49 @@ module;
 
 #include <SDL3_image/SDL_image.h>
 
+#include <entt/entity/registry.hpp>
+
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
 #include <format>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <istream>
+#include <ostream>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 export module game;
 
+import actors;
+import actorStore;
+import animation;
+import camera;
+import catalog;
+import chunk;
+import editor;
+import editHistory;
+import editJournal;
+import frameScheduler;
+import frameStats;
+import grid;
+import level;
+import levelBinary;
+import levelLoader;
+import levelSaver;
+import profiler;
 import sprite;
 import tile;
+import tileStore;
 import sdlHelpers;
 import gui;
 
@@ -57,85 +86,38 @@ struct Vec {
   float y;
 };
 
-struct Point {
-  auto operator+(const Vec &other) const -> Point {
-    return {.x = x + other.x, .y = y + other.y};
-  }
-
-  auto operator+=(const Vec &other) noexcept -> Point & {
-    x += other.x;
-    y += other.y;
-    return *this;
-  }
-
-  auto asSdlPoint() -> SDL_FPoint { return {x, y}; }
-
-  float x;
-  float y;
-};
-
-struct PolarPoint {
-  float radius;
-  Rad angle;
-};
-
-class Character {
-public:
-  Character(const Point &pos, CharacterSprite *renderable)
-      : pos_{pos}, renderable_{renderable} {}
-
-  /// set the position of the character
-  auto setPos(const Point &newPos) noexcept -> void { pos_ = newPos; }
-
-  /// set a new direction
-  auto updateAngle(Rad newAngle) noexcept -> void { vec_.angle = newAngle; }
-
-  /// set a new speed
-  auto updateSpeed(float newSpeed) noexcept -> void { vec_.radius = newSpeed; }
-
-  /// update the position of the character
-  /// \param[in] deltaTime the time since the last update
-  auto update(Uint64 deltaTime) noexcept -> void {
-    const auto vec =
-        PolarVec{.radius = static_cast<float>(deltaTime) * vec_.radius,
-                 .angle = vec_.angle};
-    pos_ += vec;
-  }
-
-  /// get the renderable
-  [[nodiscard]] auto getRenderable() const noexcept -> CharacterSprite * {
-    return renderable_;
-  };
-
-  /// set the renderable
-  auto setRenderable(CharacterSprite *newRenderable) noexcept -> void {
-    renderable_ = newRenderable;
-  };
-
-  /// update the renderable position
-  auto updateRenderable() noexcept -> void {
-    if (renderable_)
-      renderable_->setPos(pos_.asSdlPoint());
-  }
-
-  /// get the position of the character
-  [[nodiscard]] auto getPos() const noexcept -> Point { return pos_; }
-
-  static constexpr float speed{0.06};
-
-private:
-  /// character position
-  Point pos_;
-  /// direction vector
-  PolarVec vec_{};
-  /// graphic renderable
-  CharacterSprite *renderable_;
+/// options selecting how a Game runs
+export struct GameOptions {
+  /// run without showing the window nor the gui, rendering on the CPU with
+  /// the dummy video driver, for tests and benchmarks
+  bool headless{};
+  /// number of frames per second
+  Uint32 frameRate{30};
+  /// number of simulation steps per second
+  Uint32 tickRate{30};
+  /// most simulation steps run in a frame to catch up, the time left is
+  /// dropped so a slow frame does not make the next ones slower
+  Uint32 maxCatchUpSteps{5};
+  /// time source in nanoseconds, SDL_GetTicksNS when empty
+  FrameScheduler::Clock clock;
+  /// sleep for a duration in nanoseconds, SDL_DelayNS when empty
+  FrameScheduler::Sleep sleep;
+  /// the text level loaded and saved by the editor, the journal is compacted
+  /// into it
+  std::filesystem::path levelPath{"test.lvl"};
+  /// the journal of the edits made since the level was saved, replayed when
+  /// the level is loaded. Empty to keep no journal, as the headless games of
+  /// the tests and benchmarks do
+  std::filesystem::path journalPath{"test.lvl.journal"};
+  /// the binary level loaded and saved by the editor, the journal does not
+  /// apply to it
+  std::filesystem::path binaryLevelPath{"test.lvlb"};
 };
 
 export class Game final {
 public:
-  Game();
-  ~Game();
+  explicit Game(GameOptions options = {});
+  ~Game() = default;
 
   Game(const Game &) = delete;
   Game(Game &&) = delete;
@@ -146,56 +128,222 @@ public:
   auto processEvent() noexcept -> void;
   /// process event in editor mode
   auto processEventEditor(const SDL_Event &event) noexcept -> bool;
+  /// process event moving the camera
+  auto processEventCamera(const SDL_Event &event) noexcept -> bool;
   /// process event for the character
   auto processEventCharacter(const SDL_Event &event) noexcept -> bool;
 
+  /// load the tile catalog and the character sprites, replacing the
+  /// loaded ones
   auto loadEntities() noexcept -> void;
 
+  /// replace the map with a level read from a stream
+  auto loadLevel(std::istream &istream) -> void;
+  /// write the map to a stream
+  auto saveLevel(std::ostream &ostream) const -> void;
+  /// replace the map with a level parsed from its text
+  ///
+  /// \throw LevelParseError if the text is not a level, the map and the
+  /// history are left as they were
+  auto parseLevel(std::string_view text) -> void;
+  /// replace the map with a mapped binary level
+  auto loadBinaryLevel(const MappedLevel &level) -> void;
+
+  /// apply the stroke of the editor tool to the map
+  auto finishStroke() -> void;
+  /// place the selected enemy kind in the cells of the stroke, or erase the
+  /// enemies standing in them
+  ///
+  /// a cell holds at most one enemy placed by the editor
+  auto editEnemies() -> void;
+  /// change the tiles of a layer in one batch
+  ///
+  /// the floor chunks and the wall index are updated tile by tile for small
+  /// batches and rebuilt once for large ones
+  ///
+  /// \param[in] Wall whether the edits apply to the wall layer
+  /// \param[in] Edits the changes, applied in order
+  auto applyEdits(bool wall, std::span<const TileEdit> edits) -> void;
+  /// undo the last group of edits of the history
+  auto undoEdits() -> void;
+  /// redo the last undone group of edits of the history
+  auto redoEdits() -> void;
+  /// outline the cells of the stroke in progress
+  auto renderStroke() -> void;
+
+  /// remove the floor tile in a cell
+  auto eraseFloorTile(const Cell &cell) -> void;
+  /// remove the wall tile in a cell
+  auto eraseWallTile(const Cell &cell) -> void;
+  /// rebuild the floor chunks and the wall index from the map
+  auto indexMap() -> void;
+  /// start, cancel and swap in the level loaded in the background
+  auto updateLevelLoad() -> void;
+  /// append the edits to the journal and hand the level to the background
+  /// saver when requested or when the journal is long enough to compact, and
+  /// the binary level when requested
+  auto updateLevelSave() -> void;
+  /// check if the edits are journaled
+  [[nodiscard]] auto isJournaled() const noexcept -> bool {
+    return journaling_ && !options_.journalPath.empty();
+  }
+  /// write the journaled edits and stop journaling, the map no longer
+  /// derives from the text level the journal applies to
+  auto stopJournaling() -> void;
+  /// get the path the journal is moved to while the level is saved
+  [[nodiscard]] auto oldJournalPath() const -> std::filesystem::path {
+    auto path = options_.journalPath;
+    path += ".old";
+    return path;
+  }
+
+  /// add a tile of a store to the sprite batch
+  auto drawTile(const TileStore &store, TileSlot slot) -> void;
+  /// get the key used to sort a wall tile with the other wall tiles and the
+  /// characters
+  [[nodiscard]] auto wallSortKey(TileSlot slot) const noexcept -> float;
+
   auto render() noexcept -> void;
 
   auto frame() -> void;
+  /// advance the simulation by one fixed step
+  auto simulate() noexcept -> void;
   auto checkKeys() noexcept -> void;
 
   [[nodiscard]] auto done() const noexcept -> bool { return done_; }
 
+  /// get the number of frames rendered so far
+  [[nodiscard]] auto frameCount() const noexcept -> Uint64 {
+    return frameCount_;
+  }
+
+  /// get the tile kinds indexed by catalog id
+  [[nodiscard]] auto getCatalog() const noexcept
+      -> std::span<const RendererBuilder> {
+    return catalog_.tiles();
+  }
+
+  /// get the floor layer of the map
+  [[nodiscard]] auto getMap() const noexcept -> const TileStore & {
+    return map_;
+  }
+
+  /// get the wall layer of the map
+  [[nodiscard]] auto getMapWall() const noexcept -> const TileStore & {
+    return mapWall_;
+  }
+
+  /// get the enemy kinds indexed by kind id
+  [[nodiscard]] auto getEnemyKinds() const noexcept
+      -> std::span<const CharacterSprite> {
+    return catalog_.enemies();
+  }
+
+  /// get the number of enemies placed in the level
+  [[nodiscard]] auto getEnemyCount() const -> size_t {
+    return registry_.view<const Enemy>().size();
+  }
+
 private:
-  static constexpr float gridSize{16};
-  static constexpr Uint64 minFrameDuration{1000 / 30};
   static constexpr Uint32 minimizedDelay{10};
   static constexpr SDL_Point windowSize{1280, 720};
-  static constexpr Point playerStartingPoint{.x = 100, .y = 100};
-
+  /// time allowed to bake floor chunks each frame, in nanoseconds
+  static constexpr Uint64 chunkBakeBudget{2'000'000};
+  /// number of cells below the visible area where a tall tile can start
+  static constexpr int overdrawCells{2};
+  static constexpr float zoomStep{1.1};
+  static constexpr SDL_FPoint playerStartingPoint{100, 100};
+  /// speed of the player, in map pixels per millisecond
+  static constexpr float playerSpeed{0.06};
+  /// number of journal records past which the level is saved and the journal
+  /// emptied
+  static constexpr size_t journalCompactThreshold{16384};
+  /// a batch of edits larger than the level divided by this ratio rebuilds
+  /// the indices instead of updating them
+  static constexpr size_t batchReindexRatio{8};
+
+  GameOptions options_;
+  SdlContext context_{SDL_INIT_VIDEO | SDL_INIT_GAMEPAD,
+                      options_.headless ? "dummy" : nullptr};
   SdlWindow window_{"My Game", windowSize, SDL_WINDOW_HIDDEN};
-  SdlRenderer renderer_{window_.createRenderer()};
-  Gui gameGui_{window_, renderer_};
+  SdlRenderer renderer_{options_.headless ? window_.createSoftwareRenderer()
+                                          : window_.createRenderer()};
+  SpriteBatch batch_{renderer_};
+  Gui gameGui_{options_.headless ? Gui{} : Gui{window_, renderer_}};
 
   bool done_{};
 
-  size_t frameCount_{};
+  AnimationClock animationClock_;
   SdlTexturePtr texture_{nullptr, SDL_DestroyTexture};
-  Uint32 last_{};
-
-  Character player_{playerStartingPoint, nullptr};
-
-  std::vector<CharacterSprite> characters_;
-  std::vector<CharacterSprite> enemies_;
-  std::vector<RendererBuilder> tiles_;
-  std::vector<std::unique_ptr<TileConcrete>> map_;
-  std::vector<std::unique_ptr<TileConcrete>> mapWall_;
-
-  std::vector<Renderable *> toRender_;
-
-  SDL_FPoint tileCursorPos_{};
+  FrameScheduler scheduler_{options_.frameRate, options_.clock,
+                            options_.sleep};
+  /// duration of a simulation step in nanoseconds
+  Uint64 tickDuration_{SDL_NS_PER_SECOND /
+                       std::max<Uint32>(options_.tickRate, 1)};
+  /// time not simulated yet, in nanoseconds
+  Uint64 accumulator_{};
+  /// progress of the render time between the last two simulation steps
+  float interpolation_{1};
+  FrameStats frameStats_;
+  Uint64 frameCount_{};
+
+  /// the characters, as entities with a Position, a Sprite and a
+  /// SpriteAnimation. The player has a Velocity, the enemies placed in the
+  /// level an Enemy
+  entt::registry registry_;
+  entt::entity player_{registry_.create()};
+
+  /// the tile, character and enemy kinds
+  Catalog catalog_;
+  TileStore map_;
+  TileStore mapWall_;
+  /// the enemies of the level loaded or to save, kept to reuse their memory
+  ActorStore levelEnemies_;
+
+  /// the visible characters, sorted then merged with the wall tiles
+  std::vector<ActorDraw> actorDraws_;
+  /// map_ tiles grouped by chunk
+  FloorChunks floorChunks_;
+  /// mapWall_ tiles indexed by cell and sorted by wallSortKey()
+  SpatialIndex<TileSlot> wallIndex_;
+
+  Camera camera_;
+
+  Cell tileCursor_{};
   bool showTileSelector_{};
+  /// the cells the editor tool is applied to, while a mouse button is held
+  EditStroke stroke_;
+  /// the edits of the last stroke, kept to reuse their memory
+  std::vector<TileEdit> edits_;
+  /// the strokes that can be undone and redone, forgotten when the level is
+  /// replaced
+  EditHistory history_;
+
+  /// edits made since the level was saved, replayed on load, unused when
+  /// GameOptions::journalPath is empty
+  EditJournal journal_{options_.journalPath};
+  /// true while the map derives from the text level at
+  /// GameOptions::levelPath, once it is loaded from or saved to it. Only then
+  /// are the edits journaled and compacted into it
+  bool journaling_{};
+
+  /// declared after catalog_, the load and save in progress read it
+  AsyncLevelLoader levelLoader_;
+  AsyncLevelSaver levelSaver_;
 };
 
-Game::Game() {
-  if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMEPAD)) {
-    throw InitError{std::format("SDL_Init(): {}", SDL_GetError())};
+Game::Game(GameOptions options) : options_{std::move(options)} {
+  if (!options_.headless) {
+    window_.setPosition(SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
+    window_.showWindow();
   }
 
-  window_.setPosition(SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
-  window_.showWindow();
+  registry_.emplace<Position>(
+      player_, Position{.current = playerStartingPoint,
+                        .previous = playerStartingPoint});
+  registry_.emplace<Velocity>(player_, Velocity{});
+  registry_.emplace<Sprite>(player_, Sprite{});
+  registry_.emplace<SpriteAnimation>(player_, SpriteAnimation{});
 
   texture_ = renderer_.createTextureFromPath(
       "rsrc/0x72_DungeonTilesetII_v1.7/0x72_DungeonTilesetII_v1.7.png");
@@ -203,39 +351,67 @@ Game::Game() {
   loadEntities();
 }
 
-Game::~Game() { SDL_Quit(); }
-
 auto Game::loadEntities() noexcept -> void {
+  levelLoader_.cancel();
+  levelSaver_.wait();
+  registry_.get<Sprite>(player_).kind = nullptr;
+  history_.clear();
+  catalog_.clear();
+
   std::ifstream textureIndex;
   textureIndex.open("rsrc/0x72_DungeonTilesetII_v1.7/tile_list_v1.7.cpy");
-  while (!textureIndex.eof()) {
-    std::string tileType;
-    std::string tileName;
-    SDL_FRect sourceRect;
-    textureIndex >> tileType >> tileName >> sourceRect.x >> sourceRect.y >>
-        sourceRect.w >> sourceRect.h;
-
-    if (tileType == "terrain") {
-      tiles_.emplace_back(tileName, false, sourceRect);
-    } else if (tileType == "terrainA") {
-      tiles_.emplace_back(tileName, true, sourceRect);
-    } else if (tileType == "character") {
-      characters_.emplace_back(tileName, sourceRect, true, true);
-    } else if (tileType == "enemy") {
-      enemies_.emplace_back(tileName, sourceRect, true, false);
-    } else if (tileType == "enemyw") {
-      enemies_.emplace_back(tileName, sourceRect, false, false);
-    } else {
-      textureIndex.ignore();
-    }
-  }
+  catalog_.load(textureIndex);
+  bindEnemyKinds(registry_, catalog_.enemies());
+}
+
+auto Game::loadLevel(std::istream &istream) -> void {
+  const ProfileZone zone{"Game::loadLevel"};
+  stopJournaling();
+  ::loadLevel(istream, catalog_, map_, mapWall_, levelEnemies_);
+  spawnEnemies(registry_, levelEnemies_, catalog_.enemies());
+  history_.clear();
+  indexMap();
+}
+
+auto Game::saveLevel(std::ostream &ostream) const -> void {
+  const ProfileZone zone{"Game::saveLevel"};
+  ActorStore enemies;
+  collectEnemies(registry_, enemies);
+  ::saveLevel(ostream, catalog_.tiles(), map_, mapWall_, catalog_.enemies(),
+              enemies);
+}
+
+auto Game::parseLevel(std::string_view text) -> void {
+  const ProfileZone zone{"Game::parseLevel"};
+  TileStore map;
+  TileStore mapWall;
+  ::parseLevel(text, catalog_, map, mapWall, levelEnemies_);
+
+  stopJournaling();
+  std::swap(map_, map);
+  std::swap(mapWall_, mapWall);
+  spawnEnemies(registry_, levelEnemies_, catalog_.enemies());
+  history_.clear();
+  indexMap();
+}
+
+auto Game::loadBinaryLevel(const MappedLevel &level) -> void {
+  const ProfileZone zone{"Game::loadBinaryLevel"};
+  stopJournaling();
+  ::loadBinaryLevel(level, catalog_, map_, mapWall_, levelEnemies_);
+  spawnEnemies(registry_, levelEnemies_, catalog_.enemies());
+  history_.clear();
+  indexMap();
 }
 
 auto Game::processEvent() noexcept -> void {
+  const ProfileZone zone{"Game::processEvent"};
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
 
-    if (Gui::processEvent(event)) {
+    // a stroke started on the map ends on the map, even released over the
+    // Gui
+    if (gameGui_.processEvent(event) && !stroke_.isActive()) {
       showTileSelector_ = false;
       continue;
     }
@@ -245,8 +421,7 @@ auto Game::processEvent() noexcept -> void {
 
     SDL_GetMouseState(&mousePos.x, &mousePos.y);
 
-    tileCursorPos_ = {.x = mousePos.x - std::fmod(mousePos.x, gridSize * 2),
-                      .y = mousePos.y - std::fmod(mousePos.y, gridSize * 2)};
+    tileCursor_ = cellAt(camera_.screenToMap(mousePos));
 
     if (event.type == SDL_EVENT_QUIT) {
       done_ = true;
@@ -256,8 +431,12 @@ auto Game::processEvent() noexcept -> void {
       done_ = true;
     }
 
+    if (processEventCamera(event)) {
+      continue;
+    }
+
     if (gameGui_.isEditorMode() && processEventEditor(event)) {
-      return;
+      continue;
     }
 
     processEventCharacter(event);
@@ -265,16 +444,33 @@ auto Game::processEvent() noexcept -> void {
 }
 
 auto Game::frame() -> void {
-  auto now = SDL_GetTicks();
-  auto fps = now - last_;
-  if (fps >= minFrameDuration) {
-    last_ = now;
-    ++frameCount_;
-  } else {
-    return;
+  const ProfileZone zone{"Game::frame"};
+  const auto elapsed = scheduler_.waitNextFrame();
+  animationClock_.update(scheduler_.getFrameStart() / SDL_NS_PER_MS);
+
+  updateLevelLoad();
+  // the edits made while a level loads would be dropped with the replaced map
+  const auto loading = levelLoader_.isLoading();
+  if (gameGui_.takeUndoRequest() && !loading) {
+    undoEdits();
   }
+  if (gameGui_.takeRedoRequest() && !loading) {
+    redoEdits();
+  }
+  gameGui_.editHistory(!loading && history_.canUndo(),
+                       !loading && history_.canRedo());
+  updateLevelSave();
+
+  frameStats_.beginFrame(elapsed);
+  auto phaseStart = SDL_GetTicksNS();
+  const auto endPhase = [&](FramePhase phase) {
+    const auto now = SDL_GetTicksNS();
+    frameStats_.addPhase(phase, now - phaseStart);
+    phaseStart = now;
+  };
 
-  gameGui_.frameRenderingDuration(fps);
+  gameGui_.frameStats(frameStats_);
+  gameGui_.framePacing(scheduler_.getJitter(), scheduler_.getMaxJitter());
 
   if (SDL_WINDOW_MINIMIZED & window_.getWindowFlags()) {
     SDL_Delay(minimizedDelay);
@@ -284,79 +480,290 @@ auto Game::frame() -> void {
   processEvent();
 
   checkKeys();
-
-  player_.update(fps);
+  endPhase(FramePhase::events);
+
+  accumulator_ += elapsed;
+  Uint32 steps{0};
+  for (; accumulator_ >= tickDuration_ && steps < options_.maxCatchUpSteps;
+       ++steps) {
+    simulate();
+    accumulator_ -= tickDuration_;
+  }
+  if (steps == options_.maxCatchUpSteps) {
+    accumulator_ %= tickDuration_;
+  }
+  interpolation_ = static_cast<float>(accumulator_) /
+                   static_cast<float>(tickDuration_);
+  endPhase(FramePhase::simulation);
 
   constexpr SDL_Color clearColor{0, 0, 0, 255};
   renderer_.setRenderDrawColor(clearColor);
   renderer_.renderClear();
+  renderer_.resetDrawCalls();
 
   render();
+  gameGui_.frameDrawCalls(renderer_.drawCalls());
 
   if (gameGui_.isEditorMode() && showTileSelector_) {
-    const SDL_FRect cursorRect{tileCursorPos_.x, tileCursorPos_.y, gridSize * 2,
-                               gridSize * 2};
+    const auto cursorRect = camera_.mapToScreen(cellRect(tileCursor_));
 
     constexpr SDL_Color cursorColor{150, 150, 150, 255};
     renderer_.setRenderDrawColor(cursorColor);
     renderer_.renderRect(cursorRect);
   }
+  renderStroke();
+  endPhase(FramePhase::render);
+
+  gameGui_.render(renderer_, catalog_);
+  endPhase(FramePhase::gui);
 
-  gameGui_.render(renderer_, characters_, enemies_, tiles_, map_, mapWall_);
   renderer_.renderPresent();
+  endPhase(FramePhase::present);
+  frameStats_.endFrame();
+  ++frameCount_;
+}
+
+auto Game::simulate() noexcept -> void {
+  const auto deltaTime =
+      static_cast<float>(tickDuration_) / static_cast<float>(SDL_NS_PER_MS);
+  moveActors(registry_, deltaTime);
+}
+
+auto Game::processEventCamera(const SDL_Event &event) noexcept -> bool {
+  if (event.type == SDL_EVENT_MOUSE_MOTION &&
+      (event.motion.state & SDL_BUTTON_MMASK) != 0) {
+    camera_.move({-event.motion.xrel, -event.motion.yrel});
+    return true;
+  }
+  if (event.type == SDL_EVENT_MOUSE_WHEEL && event.wheel.y != 0) {
+    camera_.zoomAt(event.wheel.y > 0 ? zoomStep : 1 / zoomStep,
+                   {event.wheel.mouse_x, event.wheel.mouse_y});
+    return true;
+  }
+  return false;
 }
 
 auto Game::processEventEditor(const SDL_Event &event) noexcept -> bool {
-  if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN &&
-      event.button.button == SDL_BUTTON_LEFT) {
-    SDL_FPoint point;
-    point.x = (event.button.x - std::fmod(event.button.x, gridSize * 2)) / 2;
-    point.y = (event.button.y - std::fmod(event.button.y, gridSize * 2) +
-               gridSize * 2) /
-              2;
-
-    auto tile = tiles_[gameGui_.getTileIndex()];
-    if (gameGui_.isWall()) {
-      std::erase_if(mapWall_,
-                    [point](auto &tile) { return tile->isSamePos(point); });
-      mapWall_.push_back(tile.build(point, gameGui_.isLevel()));
-    } else {
-      std::erase_if(map_,
-                    [point](auto &tile) { return tile->isSamePos(point); });
-      map_.push_back(tile.build(point, gameGui_.isLevel()));
+  if (levelLoader_.isLoading()) {
+    // the edits made while a level loads would be dropped with the replaced
+    // map
+    stroke_.end();
+    return false;
+  }
+  if (event.type == SDL_EVENT_KEY_DOWN && !stroke_.isActive() &&
+      (event.key.mod & SDL_KMOD_CTRL) != 0) {
+    if (event.key.key == SDLK_Z && (event.key.mod & SDL_KMOD_SHIFT) == 0) {
+      undoEdits();
+      return true;
+    }
+    if (event.key.key == SDLK_Y || event.key.key == SDLK_Z) {
+      redoEdits();
+      return true;
     }
-    return true;
   }
   if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN &&
-      event.button.button == SDL_BUTTON_RIGHT) {
-    SDL_FPoint point;
-    point.x = (event.button.x - std::fmod(event.button.x, gridSize * 2)) / 2;
-    point.y = (event.button.y - std::fmod(event.button.y, gridSize * 2) +
-               gridSize * 2) /
-              2;
-
-    if (gameGui_.isWall()) {
-      std::erase_if(mapWall_,
-                    [point](auto &tile) { return tile->isSamePos(point); });
-    } else {
-      std::erase_if(map_,
-                    [point](auto &tile) { return tile->isSamePos(point); });
+      (event.button.button == SDL_BUTTON_LEFT ||
+       event.button.button == SDL_BUTTON_RIGHT)) {
+    if (!stroke_.isActive()) {
+      stroke_.begin(
+          gameGui_.getEditorTool(), event.button.button == SDL_BUTTON_RIGHT,
+          cellAt(camera_.screenToMap({event.button.x, event.button.y})));
     }
     return true;
   }
+  if (event.type == SDL_EVENT_MOUSE_MOTION && stroke_.isActive()) {
+    stroke_.moveTo(
+        cellAt(camera_.screenToMap({event.motion.x, event.motion.y})));
+    return true;
+  }
+  if (event.type == SDL_EVENT_MOUSE_BUTTON_UP && stroke_.isActive() &&
+      event.button.button ==
+          (stroke_.isErase() ? SDL_BUTTON_RIGHT : SDL_BUTTON_LEFT)) {
+    stroke_.moveTo(
+        cellAt(camera_.screenToMap({event.button.x, event.button.y})));
+    finishStroke();
+    return true;
+  }
   return false;
 }
 
+auto Game::finishStroke() -> void {
+  const ProfileZone zone{"Game::finishStroke"};
+  const auto wall = gameGui_.isWall();
+  const auto catalogId = stroke_.isErase()
+                             ? TileStore::freeId
+                             : static_cast<CatalogId>(gameGui_.getTileIndex());
+  const auto level = gameGui_.isLevel();
+  const auto addEdit = [&](const Cell &cell) {
+    edits_.push_back({.cell = cell, .catalogId = catalogId, .level = level});
+  };
+
+  edits_.clear();
+  switch (stroke_.getTool()) {
+  case EditorTool::paint:
+    std::ranges::for_each(stroke_.cells(), addEdit);
+    break;
+  case EditorTool::rectangle:
+    stroke_.area().forEach(addEdit);
+    break;
+  case EditorTool::fill:
+    // an empty region is only bounded by the visible cells
+    floodFill(wall ? mapWall_ : map_, stroke_.getAnchor(),
+              cellsIn(camera_.visibleArea(windowSize)), addEdit);
+    break;
+  case EditorTool::enemy:
+    // the enemies are not tiles, they are kept out of the edits and the
+    // history
+    editEnemies();
+    stroke_.end();
+    return;
+  }
+  stroke_.end();
+
+  history_.beginGroup(wall);
+  applyEdits(wall, edits_);
+  history_.endGroup();
+}
+
+auto Game::editEnemies() -> void {
+  const ProfileZone zone{"Game::editEnemies"};
+  std::unordered_set<std::uint32_t> cells;
+  for (const auto &cell : stroke_.cells()) {
+    cells.insert(packCell(cell));
+  }
+
+  // the enemies of the stroke cells are erased, or keep their cell. The
+  // current entity of a view can be destroyed while iterating it
+  registry_.view<const Enemy, const Position>().each(
+      [&](entt::entity enemy, const Enemy &, const Position &position) {
+        const auto cell = packCell(cellOf(position.current));
+        if (!cells.contains(cell)) {
+          return;
+        }
+        if (stroke_.isErase()) {
+          registry_.destroy(enemy);
+        } else {
+          cells.erase(cell);
+        }
+      });
+  if (stroke_.isErase() || catalog_.enemies().empty()) {
+    return;
+  }
+
+  const auto kindId = static_cast<ActorKindId>(gameGui_.getEnemyIndex());
+  for (const auto &cell : stroke_.cells()) {
+    if (cells.contains(packCell(cell))) {
+      spawnEnemy(registry_, catalog_.enemies(), kindId, tilePosOf(cell),
+                 {.running = gameGui_.isEnemyRunning()});
+    }
+  }
+}
+
+auto Game::undoEdits() -> void {
+  const ProfileZone zone{"Game::undoEdits"};
+  if (const auto wall = history_.undo(edits_)) {
+    applyEdits(*wall, edits_);
+  }
+}
+
+auto Game::redoEdits() -> void {
+  const ProfileZone zone{"Game::redoEdits"};
+  if (const auto wall = history_.redo(edits_)) {
+    applyEdits(*wall, edits_);
+  }
+}
+
+auto Game::applyEdits(bool wall, std::span<const TileEdit> edits) -> void {
+  const ProfileZone zone{"Game::applyEdits"};
+  auto &store = wall ? mapWall_ : map_;
+  // past a share of the level, rebuilding the indices once costs less than
+  // updating them tile by tile
+  const auto reindex =
+      edits.size() * batchReindexRatio > map_.size() + mapWall_.size();
+
+  for (const auto &edit : edits) {
+    const auto erase = edit.catalogId == TileStore::freeId;
+    const auto slot = store.find(edit.cell);
+    if (slot ? !erase && store.catalogId(*slot) == edit.catalogId &&
+                   store.level(*slot) == edit.level
+             : erase) {
+      continue;
+    }
+
+    history_.record(edit.cell,
+                    slot ? store.catalogId(*slot) : TileStore::freeId,
+                    slot && store.level(*slot), edit.catalogId, edit.level);
+    if (isJournaled()) {
+      if (erase) {
+        journal_.erase(wall, edit.cell);
+      } else {
+        journal_.place(wall, edit.cell, edit.catalogId, edit.level);
+      }
+    }
+
+    if (reindex) {
+      if (slot) {
+        store.erase(*slot);
+      }
+    } else if (wall) {
+      eraseWallTile(edit.cell);
+    } else {
+      eraseFloorTile(edit.cell);
+    }
+    if (erase) {
+      continue;
+    }
+
+    const auto newSlot = store.insert(edit.cell, edit.catalogId, edit.level);
+    if (reindex) {
+      continue;
+    }
+    if (wall) {
+      wallIndex_.insert(edit.cell, wallSortKey(newSlot), newSlot);
+    } else {
+      floorChunks_.insert(edit.cell, newSlot,
+                          !catalog_.tile(edit.catalogId).isBakeable());
+    }
+  }
+
+  if (reindex) {
+    indexMap();
+  }
+}
+
+auto Game::renderStroke() -> void {
+  if (!stroke_.isActive()) {
+    return;
+  }
+  constexpr SDL_Color strokeColor{220, 180, 60, 255};
+  renderer_.setRenderDrawColor(strokeColor);
+  if (stroke_.getTool() == EditorTool::paint ||
+      stroke_.getTool() == EditorTool::enemy) {
+    for (const auto &cell : stroke_.cells()) {
+      renderer_.renderRect(camera_.mapToScreen(cellRect(cell)));
+    }
+  } else if (stroke_.getTool() == EditorTool::rectangle) {
+    const auto area = stroke_.area();
+    const auto first = cellRect(area.first);
+    const auto last = cellRect(area.last);
+    renderer_.renderRect(camera_.mapToScreen(
+        {first.x, first.y, last.x + last.w - first.x,
+         last.y + last.h - first.y}));
+  }
+}
+
 auto Game::processEventCharacter(const SDL_Event &event) noexcept -> bool {
 
   if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_A) {
-    player_.getRenderable()->setHit();
+    registry_.get<SpriteAnimation>(player_).hitFrames =
+        CharacterSprite::hitFrameCount;
     return true;
   }
   return false;
 }
 
 auto Game::checkKeys() noexcept -> void {
+  const ProfileZone zone{"Game::checkKeys"};
   SDL_PumpEvents();
 
   int ksize{0};
@@ -372,64 +779,208 @@ auto Game::checkKeys() noexcept -> void {
   constexpr Rad dirLeft{Rad::fromDeg(180)};
   constexpr Rad dirRight{Rad::fromDeg(0)};
 
+  auto &velocity = registry_.get<Velocity>(player_);
+  auto &animation = registry_.get<SpriteAnimation>(player_);
+  const auto run = [&](Rad angle) {
+    const Vec vec{PolarVec{.radius = playerSpeed, .angle = angle}};
+    velocity = {.x = vec.x, .y = vec.y};
+    animation.running = true;
+  };
+
   if (keys[SDL_SCANCODE_UP]) {
-    player_.updateSpeed(Character::speed);
     if (keys[SDL_SCANCODE_LEFT]) {
-      player_.updateAngle(dirUpLeft);
-      player_.getRenderable()->setRunning(true);
+      run(dirUpLeft);
+      animation.flip = true;
     } else if (keys[SDL_SCANCODE_RIGHT]) {
-      player_.updateAngle(dirUpRight);
-      player_.getRenderable()->setRunning(false);
+      run(dirUpRight);
+      animation.flip = false;
     } else {
-      player_.getRenderable()->setRunning();
-      player_.updateAngle(dirUp);
+      run(dirUp);
     }
   } else if (keys[SDL_SCANCODE_DOWN]) {
-    player_.updateSpeed(Character::speed);
     if (keys[SDL_SCANCODE_LEFT]) {
-      player_.getRenderable()->setRunning(true);
-      player_.updateAngle(dirDownLeft);
+      run(dirDownLeft);
+      animation.flip = true;
     } else if (keys[SDL_SCANCODE_RIGHT]) {
-      player_.getRenderable()->setRunning(false);
-      player_.updateAngle(dirDownRight);
+      run(dirDownRight);
+      animation.flip = false;
     } else {
-      player_.getRenderable()->setRunning();
-      player_.updateAngle(dirDown);
+      run(dirDown);
     }
   } else if (keys[SDL_SCANCODE_LEFT]) {
-    player_.updateSpeed(Character::speed);
-    player_.getRenderable()->setRunning(true);
-    player_.updateAngle(dirLeft);
+    run(dirLeft);
+    animation.flip = true;
   } else if (keys[SDL_SCANCODE_RIGHT]) {
-    player_.updateSpeed(Character::speed);
-    player_.getRenderable()->setRunning(false);
-    player_.updateAngle(dirRight);
+    run(dirRight);
+    animation.flip = false;
   } else {
-    player_.updateSpeed(0);
-    if (player_.getRenderable())
-      player_.getRenderable()->setIdle();
+    velocity = {};
+    animation.running = false;
   }
 }
 
-auto Game::render() noexcept -> void {
-  for (const auto &tile : map_) {
-    tile->render(renderer_, texture_, frameCount_);
+auto Game::eraseFloorTile(const Cell &cell) -> void {
+  if (auto slot = map_.find(cell)) {
+    floorChunks_.erase(cell, *slot);
+    map_.erase(*slot);
+  }
+}
+
+auto Game::eraseWallTile(const Cell &cell) -> void {
+  if (auto slot = mapWall_.find(cell)) {
+    wallIndex_.erase(cell, wallSortKey(*slot), *slot);
+    mapWall_.erase(*slot);
+  }
+}
+
+auto Game::indexMap() -> void {
+  indexLevel(catalog_.tiles(), map_, mapWall_, floorChunks_, wallIndex_);
+}
+
+auto Game::wallSortKey(TileSlot slot) const noexcept -> float {
+  return ::wallSortKey(mapWall_, catalog_.tiles(), slot);
+}
+
+auto Game::stopJournaling() -> void {
+  if (isJournaled()) {
+    journal_.flush(catalog_.tiles());
   }
+  journaling_ = false;
+}
 
-  toRender_.clear();
-  for (const auto &item : mapWall_) {
-    toRender_.push_back(item.get());
+auto Game::updateLevelSave() -> void {
+  if (gameGui_.takeBinarySaveRequest()) {
+    collectEnemies(registry_, levelEnemies_);
+    levelSaver_.saveBinary(options_.binaryLevelPath, catalog_.tiles(), map_,
+                           mapWall_, catalog_.enemies(), levelEnemies_);
   }
 
-  player_.setRenderable(&characters_[gameGui_.getCharacterIndex()]);
-  player_.updateRenderable();
-  toRender_.push_back(player_.getRenderable());
+  auto save = gameGui_.takeSaveRequest();
+  if (save && !journaling_ && !options_.journalPath.empty()) {
+    // a map not loaded from the text level replaces it, the edits journaled
+    // against the text level no longer apply once the save is written. The
+    // saves in progress are waited for so they do not remove the old journal
+    // first
+    levelSaver_.wait();
+    journal_.rotate(oldJournalPath());
+    journaling_ = true;
+  }
+  std::function<void()> onWritten;
+  if (isJournaled()) {
+    journal_.flush(catalog_.tiles());
+
+    // the edits move to the old journal, replayed until the saved level
+    // replaces the level file. While a save is written or after it failed,
+    // the old journal stays and the following edits stay in the current one
+    auto oldJournal = oldJournalPath();
+    save = save || (journal_.size() >= journalCompactThreshold &&
+                    !levelSaver_.isSaving() &&
+                    !std::filesystem::exists(oldJournal));
+    if (save) {
+      if (!std::filesystem::exists(oldJournal)) {
+        journal_.rotate(oldJournal);
+      }
+      onWritten = [oldJournal = std::move(oldJournal)] {
+        std::filesystem::remove(oldJournal);
+      };
+    }
+  }
+  if (save) {
+    collectEnemies(registry_, levelEnemies_);
+    levelSaver_.save(options_.levelPath, catalog_.tiles(), map_, mapWall_,
+                     catalog_.enemies(), levelEnemies_, std::move(onWritten));
+  }
+  if (auto error = levelSaver_.takeError()) {
+    SDL_Log("%s", error->c_str());
+  }
+  gameGui_.levelSaving(levelSaver_.isSaving());
+}
 
-  std::ranges::sort(toRender_, [](auto &lhs, auto &rhs) {
-    return lhs->getPos().y < rhs->getPos().y;
-  });
+auto Game::updateLevelLoad() -> void {
+  if (gameGui_.takeLoadRequest()) {
+    // the journals are replayed even when the map did not come from the text
+    // level, they apply to it. The edits of the last frame are written first
+    if (isJournaled()) {
+      journal_.flush(catalog_.tiles());
+    }
+    std::vector<std::filesystem::path> journals;
+    if (!options_.journalPath.empty()) {
+      journals = {oldJournalPath(), options_.journalPath};
+    }
+    levelLoader_.start(options_.levelPath, catalog_, std::move(journals));
+  }
+  if (gameGui_.takeBinaryLoadRequest()) {
+    // the binary level may be waiting to be written
+    levelSaver_.wait();
+    levelLoader_.startBinary(options_.binaryLevelPath, catalog_);
+  }
+  if (gameGui_.takeLoadCancelRequest()) {
+    levelLoader_.cancel();
+  }
 
-  for (const auto &tile : toRender_) {
-    tile->render(renderer_, texture_, frameCount_);
+  if (auto level = levelLoader_.takeLoaded()) {
+    if (level->format == LevelFormat::binary) {
+      stopJournaling();
+    } else {
+      journaling_ = true;
+    }
+    // the replaced level is destroyed with level, on this thread, which owns
+    // the chunk textures
+    std::swap(map_, level->map);
+    std::swap(mapWall_, level->mapWall);
+    std::swap(floorChunks_, level->floorChunks);
+    std::swap(wallIndex_, level->wallIndex);
+    spawnEnemies(registry_, level->enemies, catalog_.enemies());
+    history_.clear();
   }
+  if (auto error = levelLoader_.takeError()) {
+    SDL_Log("%s", error->c_str());
+  }
+
+  gameGui_.levelLoadProgress(
+      levelLoader_.isLoading()
+          ? std::optional<float>{levelLoader_.getProgress()}
+          : std::nullopt);
+}
+
+auto Game::drawTile(const TileStore &store, TileSlot slot) -> void {
+  catalog_.tile(store.catalogId(slot))
+      .render(batch_, texture_, store.position(slot), animationClock_);
+}
+
+auto Game::render() noexcept -> void {
+  const ProfileZone zone{"Game::render"};
+  const auto view = camera_.visibleArea(windowSize);
+  batch_.setView({.origin = camera_.getOrigin(), .scale = camera_.getZoom()});
+
+  floorChunks_.render(renderer_, batch_, view, chunkBakeBudget,
+                      [this](TileSlot slot) { drawTile(map_, slot); });
+
+  auto lastCell = cellAt({view.x + view.w, view.y + view.h});
+  lastCell.y += overdrawCells;
+
+  registry_.get<Sprite>(player_).kind =
+      &catalog_.characters()[gameGui_.getCharacterIndex()];
+  actorDraws_.clear();
+  collectActors(registry_, interpolation_, view, actorDraws_);
+  sortActors(actorDraws_);
+
+  // the walls come sorted from the index, merge the characters in
+  const auto drawActor = [this](const ActorDraw &draw) {
+    draw.kind->render(batch_, texture_, draw.pos, draw.animation,
+                      animationClock_);
+  };
+  auto character = actorDraws_.cbegin();
+  wallIndex_.forEachIn(
+      cellAt({view.x, view.y}), lastCell, [&](float key, TileSlot slot) {
+        for (; character != actorDraws_.cend() && character->sortKey < key;
+             ++character) {
+          drawActor(*character);
+        }
+        drawTile(mapWall_, slot);
+      });
+  std::for_each(character, actorDraws_.cend(), drawActor);
+  animateActors(registry_);
+
+  batch_.flush();
 }
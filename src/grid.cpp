@@ -0,0 +1,334 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+export module grid;
+
+/// size of a grid cell in texture pixels
+export constexpr float gridSize{16};
+
+/// scale between texture pixels and map pixels
+export constexpr float pixelScale{2};
+
+/// number of cells on each side of a chunk
+export constexpr int chunkCells{32};
+
+/// size of a chunk side in map pixels
+export constexpr float chunkPixels{chunkCells * gridSize * pixelScale};
+
+/// a cell of the tile grid
+export struct Cell {
+  int x;
+  int y;
+
+  auto operator==(const Cell &) const -> bool = default;
+};
+
+/// a square of chunkCells * chunkCells cells
+export struct ChunkCoord {
+  int x;
+  int y;
+
+  auto operator==(const ChunkCoord &) const -> bool = default;
+};
+
+/// hash for Cell and ChunkCoord
+export struct GridHash {
+  template <class Coord>
+  auto operator()(const Coord &coord) const noexcept -> size_t {
+    const auto packed = (static_cast<std::uint64_t>(
+                             static_cast<std::uint32_t>(coord.x))
+                         << 32U) |
+                        static_cast<std::uint32_t>(coord.y);
+    return std::hash<std::uint64_t>{}(packed);
+  }
+};
+
+/// get the cell of a tile
+///
+/// \param[in] TilePos the tile position, the bottom left corner of its cell
+export auto cellOf(const SDL_FPoint &tilePos) noexcept -> Cell {
+  return {.x = static_cast<int>(std::floor(tilePos.x / gridSize)),
+          .y = static_cast<int>(std::floor(tilePos.y / gridSize)) - 1};
+}
+
+/// get the position of a tile placed in a cell
+export auto tilePosOf(const Cell &cell) noexcept -> SDL_FPoint {
+  return {static_cast<float>(cell.x) * gridSize,
+          static_cast<float>(cell.y + 1) * gridSize};
+}
+
+/// get the cell containing a point in map pixels
+export auto cellAt(const SDL_FPoint &point) noexcept -> Cell {
+  constexpr float cellPixels{gridSize * pixelScale};
+  return {.x = static_cast<int>(std::floor(point.x / cellPixels)),
+          .y = static_cast<int>(std::floor(point.y / cellPixels))};
+}
+
+/// get the area covered by a cell in map pixels
+export auto cellRect(const Cell &cell) noexcept -> SDL_FRect {
+  constexpr float cellPixels{gridSize * pixelScale};
+  return {static_cast<float>(cell.x) * cellPixels,
+          static_cast<float>(cell.y) * cellPixels, cellPixels, cellPixels};
+}
+
+/// a rectangle of cells, first and last included
+export struct CellArea {
+  Cell first;
+  Cell last;
+
+  /// get the area between two opposite corners
+  [[nodiscard]] static constexpr auto between(const Cell &corner,
+                                              const Cell &oppositeCorner)
+      -> CellArea {
+    return {.first = {.x = std::min(corner.x, oppositeCorner.x),
+                      .y = std::min(corner.y, oppositeCorner.y)},
+            .last = {.x = std::max(corner.x, oppositeCorner.x),
+                     .y = std::max(corner.y, oppositeCorner.y)}};
+  }
+
+  [[nodiscard]] constexpr auto width() const noexcept -> int {
+    return last.x - first.x + 1;
+  }
+  [[nodiscard]] constexpr auto height() const noexcept -> int {
+    return last.y - first.y + 1;
+  }
+
+  [[nodiscard]] constexpr auto contains(const Cell &cell) const noexcept
+      -> bool {
+    return cell.x >= first.x && cell.x <= last.x && cell.y >= first.y &&
+           cell.y <= last.y;
+  }
+
+  /// get the cell of the area nearest to a cell
+  [[nodiscard]] constexpr auto clamp(const Cell &cell) const noexcept
+      -> Cell {
+    return {.x = std::clamp(cell.x, first.x, last.x),
+            .y = std::clamp(cell.y, first.y, last.y)};
+  }
+
+  /// call a visitor with every cell of the area, row by row
+  template <class Visitor> auto forEach(Visitor &&visitor) const -> void {
+    for (int y = first.y; y <= last.y; ++y) {
+      for (int x = first.x; x <= last.x; ++x) {
+        visitor(Cell{.x = x, .y = y});
+      }
+    }
+  }
+};
+
+/// get the area of the cells of an area in map pixels, partially covered
+/// cells included
+export auto cellsIn(const SDL_FRect &rect) noexcept -> CellArea {
+  return {.first = cellAt({rect.x, rect.y}),
+          .last = cellAt({rect.x + rect.w, rect.y + rect.h})};
+}
+
+/// call a visitor with the cells of a line, both ends included
+///
+/// each cell touches the previous one by a side or a corner, so a line drawn
+/// between two mouse positions has no gap
+export template <class Visitor>
+auto forEachLineCell(const Cell &from, const Cell &to, Visitor &&visitor)
+    -> void {
+  // Bresenham's line algorithm
+  const int deltaX{std::abs(to.x - from.x)};
+  const int deltaY{-std::abs(to.y - from.y)};
+  const int stepX{from.x < to.x ? 1 : -1};
+  const int stepY{from.y < to.y ? 1 : -1};
+  int error{deltaX + deltaY};
+  auto cell = from;
+  while (true) {
+    visitor(cell);
+    if (cell == to) {
+      return;
+    }
+    const auto doubledError = 2 * error;
+    if (doubledError >= deltaY) {
+      error += deltaY;
+      cell.x += stepX;
+    }
+    if (doubledError <= deltaX) {
+      error += deltaX;
+      cell.y += stepY;
+    }
+  }
+}
+
+/// get the chunk containing a cell
+export constexpr auto chunkOf(const Cell &cell) noexcept -> ChunkCoord {
+  constexpr auto floorDiv = [](int value) {
+    return (value >= 0 ? value : value - (chunkCells - 1)) / chunkCells;
+  };
+  return {.x = floorDiv(cell.x), .y = floorDiv(cell.y)};
+}
+
+/// get the chunk containing a point in map pixels
+export auto chunkAt(const SDL_FPoint &point) noexcept -> ChunkCoord {
+  return {.x = static_cast<int>(std::floor(point.x / chunkPixels)),
+          .y = static_cast<int>(std::floor(point.y / chunkPixels))};
+}
+
+/// get the area covered by a chunk in map pixels
+export auto chunkRect(const ChunkCoord &chunk) noexcept -> SDL_FRect {
+  return {static_cast<float>(chunk.x) * chunkPixels,
+          static_cast<float>(chunk.y) * chunkPixels, chunkPixels,
+          chunkPixels};
+}
+
+/// items indexed by cell and kept sorted by a key
+///
+/// the cells are grouped in vertical strips, each keeping its items sorted by
+/// key, so visiting an area only touches the strips it overlaps and yields the
+/// items in key order without sorting them. The key of an item can not be
+/// lower than the y position of the tiles of its cell (tilePosOf).
+///
+/// \tparam Item the type of the indexed items, compared with ==
+export template <class Item> class SpatialIndex {
+public:
+  /// add an item in a cell, keeping its strip sorted
+  auto insert(const Cell &cell, float key, Item item) -> void {
+    auto &entries = strips_[stripOf(cell.x)];
+    const auto entryIt =
+        std::ranges::upper_bound(entries, key, {}, &Entry::key);
+    entries.insert(entryIt, {key, cell, std::move(item)});
+    updateKeyOffset(cell, key);
+  }
+
+  /// add an item in a cell without sorting its strip
+  ///
+  /// used to fill the index quickly, sort() has to be called before the next
+  /// query
+  auto append(const Cell &cell, float key, Item item) -> void {
+    strips_[stripOf(cell.x)].push_back({key, cell, std::move(item)});
+    updateKeyOffset(cell, key);
+  }
+
+  /// sort the items added by append()
+  auto sort() -> void {
+    for (auto &strip : strips_) {
+      std::ranges::stable_sort(strip.second, {}, &Entry::key);
+    }
+  }
+
+  /// remove an item from a cell
+  ///
+  /// \param[in] Cell the cell of the item
+  /// \param[in] Key the key the item was added with
+  /// \param[in] Item the item to remove
+  auto erase(const Cell &cell, float key, const Item &item) -> void {
+    auto stripIt = strips_.find(stripOf(cell.x));
+    if (stripIt == strips_.end()) {
+      return;
+    }
+    auto &entries = stripIt->second;
+    const auto [first, last] =
+        std::ranges::equal_range(entries, key, {}, &Entry::key);
+    const auto entryIt =
+        std::ranges::find_if(first, last, [&cell, &item](const Entry &entry) {
+          return entry.cell == cell && entry.item == item;
+        });
+    if (entryIt != last) {
+      entries.erase(entryIt);
+    }
+    if (entries.empty()) {
+      strips_.erase(stripIt);
+    }
+  }
+
+  /// remove every item
+  auto clear() noexcept -> void {
+    strips_.clear();
+    maxKeyOffset_ = 0;
+  }
+
+  /// call a visitor with every item in an area, in key order
+  ///
+  /// \param[in] First the top left cell of the area
+  /// \param[in] Last the bottom right cell of the area, included
+  /// \param[in] Visitor called with the key and the item of each item of the
+  /// area
+  template <class Visitor>
+  auto forEachIn(const Cell &first, const Cell &last, Visitor &&visitor)
+      -> void {
+    const auto minKey = tilePosOf(first).y;
+    const auto maxKey = tilePosOf(last).y + maxKeyOffset_;
+
+    cursors_.clear();
+    for (int strip = stripOf(first.x); strip <= stripOf(last.x); ++strip) {
+      auto stripIt = strips_.find(strip);
+      if (stripIt == strips_.end()) {
+        continue;
+      }
+      const auto &entries = stripIt->second;
+      const auto begin =
+          std::ranges::lower_bound(entries, minKey, {}, &Entry::key);
+      const auto end = std::ranges::upper_bound(begin, entries.end(), maxKey,
+                                                {}, &Entry::key);
+      if (begin != end) {
+        cursors_.push_back({std::to_address(begin), std::to_address(end)});
+      }
+    }
+
+    // merge the sorted strips
+    constexpr auto later = [](const Cursor &lhs, const Cursor &rhs) {
+      return lhs.current->key > rhs.current->key;
+    };
+    std::ranges::make_heap(cursors_, later);
+    while (!cursors_.empty()) {
+      std::ranges::pop_heap(cursors_, later);
+      auto &cursor = cursors_.back();
+      const auto &entry = *cursor.current;
+      if (entry.cell.x >= first.x && entry.cell.x <= last.x &&
+          entry.cell.y >= first.y && entry.cell.y <= last.y) {
+        visitor(entry.key, entry.item);
+      }
+      if (++cursor.current == cursor.end) {
+        cursors_.pop_back();
+      } else {
+        std::ranges::push_heap(cursors_, later);
+      }
+    }
+  }
+
+private:
+  static constexpr int stripCells{8};
+
+  struct Entry {
+    float key;
+    Cell cell;
+    Item item;
+  };
+
+  /// the part of a strip left to visit
+  struct Cursor {
+    const Entry *current;
+    const Entry *end;
+  };
+
+  static constexpr auto stripOf(int cellX) noexcept -> int {
+    return (cellX >= 0 ? cellX : cellX - (stripCells - 1)) / stripCells;
+  }
+
+  auto updateKeyOffset(const Cell &cell, float key) noexcept -> void {
+    maxKeyOffset_ = std::max(maxKeyOffset_, key - tilePosOf(cell).y);
+  }
+
+  std::unordered_map<int, std::vector<Entry>> strips_;
+  /// the highest difference between a key and its cell position
+  float maxKeyOffset_{};
+
+  /// the strips being merged by forEachIn, kept to reuse its memory
+  std::vector<Cursor> cursors_;
+};
@@ -9,14 +9,17 @@ module;
 
 #include <format>
 #include <fstream>
-#include <limits>
-#include <memory>
+#include <optional>
+#include <string>
 #include <utility>
-#include <vector>
 
 export module gui;
 
+import catalog;
+import editor;
 import sdlHelpers;
+import frameStats;
+import profiler;
 import tile;
 import sprite;
 
@@ -37,29 +40,88 @@ public:
 
   ~Gui();
 
-  auto render(const SdlRenderer &renderer,
-              std::vector<CharacterSprite> &characters,
-              std::vector<CharacterSprite> &enemies,
-              std::vector<RendererBuilder> &tiles,
-              std::vector<std::unique_ptr<TileConcrete>> &map,
-              std::vector<std::unique_ptr<TileConcrete>> &mapWall) -> void;
+  auto render(const SdlRenderer &renderer, const Catalog &catalog) -> void;
 
   [[nodiscard]] auto isEditorMode() const -> bool { return checkEditor_; }
   [[nodiscard]] auto isLevel() const -> bool { return checkLevel_; }
   [[nodiscard]] auto isRunning() const -> bool { return checkBoxRuning_; }
   [[nodiscard]] auto isWall() const -> bool { return checkBoxWall_; }
+  [[nodiscard]] auto getEditorTool() const -> EditorTool {
+    return editorTool_;
+  }
 
-  auto frameRenderingDuration(Uint64 timeToRenderFrame) {
-    this->timeToRenderFrame_ = timeToRenderFrame;
+  /// set the frame statistics to display, they have to outlive the Gui
+  auto frameStats(const FrameStats &frameStats) {
+    this->frameStats_ = &frameStats;
   }
 
-  auto renderEditorOptions(std::vector<CharacterSprite> &characters,
-                           std::vector<CharacterSprite> &enemies,
-                           std::vector<RendererBuilder> &tiles,
-                           std::vector<std::unique_ptr<TileConcrete>> &map,
-                           std::vector<std::unique_ptr<TileConcrete>> &mapWall)
+  /// set the mean and max distance of the frame intervals to the target
+  /// frame duration, in nanoseconds
+  auto framePacing(Uint64 jitter, Uint64 maxJitter) {
+    jitter_ = jitter;
+    maxJitter_ = maxJitter;
+  }
 
-      -> void;
+  /// check if saving the level has been requested since the last call
+  [[nodiscard]] auto takeSaveRequest() -> bool {
+    return std::exchange(saveRequested_, false);
+  }
+
+  /// check if saving the level in the binary format has been requested
+  /// since the last call
+  [[nodiscard]] auto takeBinarySaveRequest() -> bool {
+    return std::exchange(binarySaveRequested_, false);
+  }
+
+  /// set whether the level is being saved
+  auto levelSaving(bool saving) { levelSaving_ = saving; }
+
+  /// check if undoing the last edit has been requested since the last call
+  [[nodiscard]] auto takeUndoRequest() -> bool {
+    return std::exchange(undoRequested_, false);
+  }
+
+  /// check if redoing the last undone edit has been requested since the last
+  /// call
+  [[nodiscard]] auto takeRedoRequest() -> bool {
+    return std::exchange(redoRequested_, false);
+  }
+
+  /// set whether there are edits to undo and to redo
+  auto editHistory(bool canUndo, bool canRedo) {
+    canUndo_ = canUndo;
+    canRedo_ = canRedo;
+  }
+
+  /// check if loading the level has been requested since the last call
+  [[nodiscard]] auto takeLoadRequest() -> bool {
+    return std::exchange(loadRequested_, false);
+  }
+
+  /// check if loading the binary level has been requested since the last
+  /// call
+  [[nodiscard]] auto takeBinaryLoadRequest() -> bool {
+    return std::exchange(binaryLoadRequested_, false);
+  }
+
+  /// check if cancelling the level load has been requested since the last
+  /// call
+  [[nodiscard]] auto takeLoadCancelRequest() -> bool {
+    return std::exchange(loadCancelRequested_, false);
+  }
+
+  /// set the progress of the level load, empty when no level is loading
+  auto levelLoadProgress(std::optional<float> progress) {
+    levelLoadProgress_ = progress;
+  }
+
+  /// set the number of draw calls used to render the game of the last frame
+  auto frameDrawCalls(size_t drawCalls) { this->drawCalls_ = drawCalls; }
+
+  auto renderEditorOptions(const Catalog &catalog) -> void;
+
+  /// render the frame time percentiles, graph and phases
+  auto renderFrameStats() -> void;
 
   template <class Array>
   auto renderComboBox(const char *name, Array &array, size_t &currentIndex)
@@ -69,26 +131,46 @@ public:
   ///
   /// \param Event the event from Sdl
   /// \return true if imgui used the event
-  static auto processEvent(SDL_Event &event) -> bool;
+  auto processEvent(SDL_Event &event) const -> bool;
 
   [[nodiscard]] auto getCharacterIndex() const -> size_t {
     return characterIndex_;
   }
   [[nodiscard]] auto getEnemyIndex() const -> size_t { return enemyIndex_; }
+  /// check if the placed enemies are running
+  [[nodiscard]] auto isEnemyRunning() const -> bool { return checkBoxRuning_; }
   [[nodiscard]] auto getTileIndex() const -> size_t { return tileIndex_; }
 
 private:
+  /// whether the ImGui context has been created, a default constructed Gui
+  /// only keeps the editor options
+  bool hasContext_{};
   bool checkBoxRuning_{};
   bool checkBoxWall_{};
+  EditorTool editorTool_{EditorTool::paint};
   bool checkLevel_{};
   bool checkEditor_{};
-  Uint64 timeToRenderFrame_{};
+  bool saveRequested_{};
+  bool binarySaveRequested_{};
+  bool levelSaving_{};
+  bool undoRequested_{};
+  bool redoRequested_{};
+  bool canUndo_{};
+  bool canRedo_{};
+  bool loadRequested_{};
+  bool binaryLoadRequested_{};
+  bool loadCancelRequested_{};
+  std::optional<float> levelLoadProgress_;
+  const FrameStats *frameStats_{};
+  Uint64 jitter_{};
+  Uint64 maxJitter_{};
+  size_t drawCalls_{};
   size_t characterIndex_{};
   size_t enemyIndex_{};
   size_t tileIndex_{};
 };
 
-Gui::Gui(const SdlWindow &window, SdlRenderer renderer) {
+Gui::Gui(const SdlWindow &window, SdlRenderer renderer) : hasContext_{true} {
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   auto &imIo = ImGui::GetIO();
@@ -101,17 +183,20 @@ Gui::Gui(const SdlWindow &window, SdlRenderer renderer) {
 }
 
 Gui::~Gui() {
+  if (!hasContext_) {
+    return;
+  }
   ImGui_ImplSDLRenderer3_Shutdown();
   ImGui_ImplSDL3_Shutdown();
   ImGui::DestroyContext();
 }
 
-auto Gui::render(const SdlRenderer &renderer,
-                 std::vector<CharacterSprite> &characters,
-                 std::vector<CharacterSprite> &enemies,
-                 std::vector<RendererBuilder> &tiles,
-                 std::vector<std::unique_ptr<TileConcrete>> &map,
-                 std::vector<std::unique_ptr<TileConcrete>> &mapWall) -> void {
+auto Gui::render(const SdlRenderer &renderer, const Catalog &catalog)
+    -> void {
+  if (!hasContext_) {
+    return;
+  }
+  const ProfileZone zone{"Gui::render"};
 
   ImGui_ImplSDLRenderer3_NewFrame();
   ImGui_ImplSDL3_NewFrame();
@@ -120,36 +205,74 @@ auto Gui::render(const SdlRenderer &renderer,
   if (ImGui::BeginMainMenuBar()) {
     if (ImGui::BeginMenu("File")) {
       ImGui::MenuItem("Editor mode", nullptr, &checkEditor_);
+      if (profilingEnabled && ImGui::MenuItem("Dump trace")) {
+        std::ofstream file{"trace.json", std::ios::trunc};
+        dumpChromeTrace(file);
+      }
       ImGui::EndMenu();
     }
     ImGui::EndMainMenuBar();
   }
 
-  std::string frameRenderingDuationText =
-      std::format("frame ms:{}", timeToRenderFrame_);
-  ImGui::TextUnformatted(frameRenderingDuationText.data(),
-                         &*frameRenderingDuationText.cend());
+  renderFrameStats();
 
   if (checkEditor_) {
-    renderEditorOptions(characters, enemies, tiles, map, mapWall);
+    renderEditorOptions(catalog);
   }
 
   ImGui::Render();
   renderer.imguiRenderDrawData();
 }
 
-auto Gui::processEvent(SDL_Event &event) -> bool {
+auto Gui::processEvent(SDL_Event &event) const -> bool {
+  if (!hasContext_) {
+    return false;
+  }
 
   ImGui_ImplSDL3_ProcessEvent(&event);
   return ImGui::GetIO().WantCaptureMouse;
 }
 
+auto Gui::renderFrameStats() -> void {
+  constexpr double nsPerMs{1'000'000};
+  std::string pacingText = std::format(
+      "jitter ms:{:.2f} (max {:.2f}) draw calls:{}",
+      static_cast<double>(jitter_) / nsPerMs,
+      static_cast<double>(maxJitter_) / nsPerMs, drawCalls_);
+  ImGui::TextUnformatted(pacingText.data(), &*pacingText.cend());
+
+  if (frameStats_ == nullptr || frameStats_->size() == 0) {
+    return;
+  }
+
+  const auto percentiles = frameStats_->getPercentiles();
+  std::string frameText = std::format(
+      "frame ms p50:{:.2f} p95:{:.2f} p99:{:.2f} max:{:.2f}", percentiles.p50,
+      percentiles.p95, percentiles.p99, percentiles.max);
+  ImGui::TextUnformatted(frameText.data(), &*frameText.cend());
+
+  const auto &history = frameStats_->getHistory();
+  constexpr ImVec2 graphSize{0, 60};
+  ImGui::PlotLines("##frames", history.data(),
+                   static_cast<int>(frameStats_->size()),
+                   static_cast<int>(frameStats_->getHistoryOffset()), nullptr,
+                   0, percentiles.max, graphSize);
+
+  for (size_t index = 0; index < framePhaseCount; ++index) {
+    const auto phase = static_cast<FramePhase>(index);
+    std::string phaseText =
+        std::format("{}: {:.3f} ms", framePhaseName(phase),
+                    frameStats_->getPhaseMean(phase));
+    ImGui::TextUnformatted(phaseText.data(), &*phaseText.cend());
+  }
+}
+
 template <class Array>
 auto Gui::renderComboBox(const char *name, Array &array, size_t &currentIndex)
     -> void {
-  if (ImGui::BeginCombo(name, array[currentIndex].name().c_str())) {
+  if (ImGui::BeginCombo(name, array[currentIndex].name().data())) {
     for (auto index = 0; index < array.size(); ++index) {
-      if (ImGui::Selectable(array[index].name().c_str(),
+      if (ImGui::Selectable(array[index].name().data(),
                             std::cmp_equal(currentIndex, index))) {
         currentIndex = index;
       }
@@ -162,71 +285,72 @@ auto Gui::renderComboBox(const char *name, Array &array, size_t &currentIndex)
   }
 }
 
-auto Gui::renderEditorOptions(std::vector<CharacterSprite> &characters,
-                              std::vector<CharacterSprite> &enemies,
-                              std::vector<RendererBuilder> &tiles,
-                              std::vector<std::unique_ptr<TileConcrete>> &map,
-                              std::vector<std::unique_ptr<TileConcrete>> &mapWall)
-    -> void {
+auto Gui::renderEditorOptions(const Catalog &catalog) -> void {
+  auto characters = catalog.characters();
+  auto enemies = catalog.enemies();
+  auto tiles = catalog.tiles();
+
   ImGui::Begin("Editor");
   renderComboBox("Character Selector", characters, characterIndex_);
   renderComboBox("Enemy Selector", enemies, enemyIndex_);
 
-  if (ImGui::Checkbox("running", &checkBoxRuning_)) {
-    if (checkBoxRuning_) {
-      enemies[enemyIndex_].setRunning(false);
-    } else {
-      enemies[enemyIndex_].setIdle();
-    }
-  }
+  ImGui::Checkbox("running", &checkBoxRuning_);
 
   renderComboBox("Tile Selector", tiles, tileIndex_);
 
+  const auto toolButton = [this](const char *label, EditorTool tool) {
+    if (ImGui::RadioButton(label, editorTool_ == tool)) {
+      editorTool_ = tool;
+    }
+  };
+  toolButton("paint", EditorTool::paint);
+  ImGui::SameLine();
+  toolButton("rectangle", EditorTool::rectangle);
+  ImGui::SameLine();
+  toolButton("fill", EditorTool::fill);
+  ImGui::SameLine();
+  toolButton("enemy", EditorTool::enemy);
+
   ImGui::Checkbox("wall", &checkBoxWall_);
 
   ImGui::Checkbox("Level", &checkLevel_);
 
-  if (ImGui::Button("save")) {
-    std::fstream file;
-    file.open("test.lvl", std::ios::out | std::ios::trunc);
+  ImGui::BeginDisabled(!canUndo_);
+  if (ImGui::Button("undo")) {
+    undoRequested_ = true;
+  }
+  ImGui::EndDisabled();
+  ImGui::SameLine();
+  ImGui::BeginDisabled(!canRedo_);
+  if (ImGui::Button("redo")) {
+    redoRequested_ = true;
+  }
+  ImGui::EndDisabled();
 
-    for (auto &tile : map) {
-      file << *tile << '\n';
-    }
-    file << "=====\n";
-    for (auto &tile : mapWall) {
-      file << *tile << '\n';
-    }
+  if (ImGui::Button("save")) {
+    saveRequested_ = true;
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("save binary")) {
+    binarySaveRequested_ = true;
+  }
+  if (levelSaving_) {
+    ImGui::SameLine();
+    ImGui::TextUnformatted("saving...");
   }
 
-  if (ImGui::Button("load")) {
-    map.clear();
-    mapWall.clear();
-    std::fstream file;
-    file.open("test.lvl", std::ios::in);
-    while (!file.eof()) {
-      RendererBuilder builder;
-      file >> builder;
-      file.ignore();
-      if (file.good()) {
-        map.push_back(builder.build());
-      } else {
-        break;
-      }
+  if (levelLoadProgress_) {
+    ImGui::ProgressBar(*levelLoadProgress_);
+    if (ImGui::Button("cancel")) {
+      loadCancelRequested_ = true;
     }
-    file.clear();
-    file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-    while (!file.eof()) {
-      RendererBuilder builder;
-      file >> builder;
-      file.ignore();
-      if (file.good()) {
-
-        mapWall.push_back(builder.build());
-      } else {
-        file.clear();
-        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-      }
+  } else {
+    if (ImGui::Button("load")) {
+      loadRequested_ = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("load binary")) {
+      binaryLoadRequested_ = true;
     }
   }
 
@@ -0,0 +1,350 @@
+module;
+
+#include <SDL3/SDL_rect.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+export module level;
+
+import actorStore;
+import catalog;
+import grid;
+import profiler;
+import sdlHelpers;
+import sprite;
+import tile;
+import tileStore;
+
+/// line separating the floor tiles, the wall tiles and the enemies in a
+/// level file
+export constexpr std::string_view levelLayerSeparator{"====="};
+
+/// write the floor and wall layers and the enemies of a level
+///
+/// an enemy is written in the form:\n
+/// EnemyName x y Running\n
+/// the tiles are in the storableCells of the layers, the enemies can stand
+/// anywhere
+///
+/// \param[in] Ostream the stream to write the level to
+/// \param[in] Catalog the tile kinds indexed by catalog id
+/// \param[in] Map the floor layer
+/// \param[in] MapWall the wall layer
+/// \param[in] EnemyKinds the enemy kinds indexed by kind id
+/// \param[in] Enemies the enemies
+export auto saveLevel(std::ostream &ostream,
+                      std::span<const RendererBuilder> catalog,
+                      const TileStore &map, const TileStore &mapWall,
+                      std::span<const CharacterSprite> enemyKinds,
+                      const ActorStore &enemies) -> void {
+  const ProfileZone zone{"saveLevel"};
+  map.forEach([&](TileSlot slot) {
+    StoredTile tile{map, catalog, slot};
+    ostream << tile << '\n';
+  });
+  ostream << levelLayerSeparator << '\n';
+  mapWall.forEach([&](TileSlot slot) {
+    StoredTile tile{mapWall, catalog, slot};
+    ostream << tile << '\n';
+  });
+  ostream << levelLayerSeparator << '\n';
+  enemies.forEach([&](ActorSlot slot) {
+    ostream << enemyKinds[enemies.kindId(slot)].name() << ' '
+            << enemies.position(slot) << ' '
+            << enemies.animation(slot).running << '\n';
+  });
+}
+
+/// replace the floor and wall layers and the enemies with a level read from
+/// a stream
+///
+/// the tiles and the enemies whose name is not in the catalog are skipped,
+/// along with the tiles outside the storableCells
+///
+/// \param[in] Istream the stream to read the level from
+/// \param[in] Catalog the catalog to look the tile and enemy names up in
+/// \param[out] Map the floor layer
+/// \param[out] MapWall the wall layer
+/// \param[out] Enemies the enemies
+export auto loadLevel(std::istream &istream, const Catalog &catalog,
+                      TileStore &map, TileStore &mapWall, ActorStore &enemies)
+    -> void {
+  const ProfileZone zone{"loadLevel"};
+  map.clear();
+  mapWall.clear();
+  enemies.clear();
+
+  const auto addTile = [&catalog](TileStore &store,
+                                  const TileRecord &record) {
+    const auto cell = cellOf(record.pos);
+    if (auto catalogId = catalog.findTile(record.name);
+        catalogId && storableCells.contains(cell)) {
+      store.insert(cell, *catalogId, record.level);
+    }
+  };
+
+  TileRecord record;
+  while (!istream.eof()) {
+    istream >> record;
+    istream.ignore();
+    if (istream.good()) {
+      addTile(map, record);
+    } else {
+      break;
+    }
+  }
+  istream.clear();
+  istream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  while (!istream.eof()) {
+    istream >> record;
+    istream.ignore();
+    if (istream.good()) {
+      addTile(mapWall, record);
+      continue;
+    }
+    // a record which can not be read is skipped, unless it separates the
+    // walls from the enemies
+    istream.clear();
+    std::string line;
+    std::getline(istream, line);
+    if (line.starts_with(levelLayerSeparator)) {
+      break;
+    }
+  }
+
+  std::string name;
+  SDL_FPoint pos;
+  bool running{};
+  while (istream >> name >> pos >> running) {
+    if (auto kindId = catalog.findEnemy(name)) {
+      enemies.insert(*kindId, pos, {.running = running});
+    }
+  }
+}
+
+/// an error found while parsing a text level
+export class LevelParseError : public std::exception {
+public:
+  /// constructor
+  ///
+  /// \param[in] Message the error description
+  /// \param[in] Line the line of the error, starting at 1
+  /// \param[in] Column the column of the error, starting at 1
+  LevelParseError(std::string_view message, size_t line, size_t column)
+      : errorMessage_{std::format("{}:{}: {}", line, column, message)},
+        line_{line}, column_{column} {}
+
+  /// get the error message, prefixed by line:column
+  [[nodiscard]] auto what() const noexcept -> const char * override {
+    return errorMessage_.c_str();
+  }
+
+  [[nodiscard]] auto line() const noexcept -> size_t { return line_; }
+  [[nodiscard]] auto column() const noexcept -> size_t { return column_; }
+
+private:
+  std::string errorMessage_;
+  size_t line_;
+  size_t column_;
+};
+
+/// single pass tokenizer over the text of a level
+class LevelTokenizer {
+public:
+  explicit LevelTokenizer(std::string_view text) noexcept : text_{text} {}
+
+  [[nodiscard]] auto atEnd() const noexcept -> bool {
+    return position_ == text_.size();
+  }
+
+  /// get the number of characters parsed
+  [[nodiscard]] auto position() const noexcept -> size_t { return position_; }
+
+  /// skip the spaces and tabs before the next token or the end of the line
+  auto skipBlanks() noexcept -> void {
+    while (position_ < text_.size() &&
+           (text_[position_] == ' ' || text_[position_] == '\t')) {
+      ++position_;
+    }
+  }
+
+  /// check if the blanks are followed by the end of the line or of the text
+  [[nodiscard]] auto atLineEnd() noexcept -> bool {
+    skipBlanks();
+    return atEnd() || text_[position_] == '\n' || text_[position_] == '\r';
+  }
+
+  /// get the next token of the line
+  ///
+  /// \param[in] What the expected token, used in the error message
+  auto token(std::string_view what) -> std::string_view {
+    if (atLineEnd()) {
+      throw error(std::format("expected {}", what));
+    }
+    const auto start = position_;
+    while (position_ < text_.size() && !isSpace(text_[position_])) {
+      ++position_;
+    }
+    return text_.substr(start, position_ - start);
+  }
+
+  /// parse the next token of the line as a number
+  ///
+  /// \param[in] What the expected number, used in the error message
+  template <class Number> auto number(std::string_view what) -> Number {
+    const auto value = token(what);
+    Number result{};
+    const auto [end, errc] =
+        std::from_chars(value.data(), value.data() + value.size(), result);
+    if (errc != std::errc{} || end != value.data() + value.size()) {
+      throw errorAt(value, std::format("expected {}, found '{}'", what, value));
+    }
+    return result;
+  }
+
+  /// move after the end of the current line
+  auto endLine() -> void {
+    if (!atLineEnd()) {
+      throw error("expected the end of the line");
+    }
+    if (position_ < text_.size() && text_[position_] == '\r') {
+      ++position_;
+    }
+    if (position_ < text_.size() && text_[position_] == '\n') {
+      ++position_;
+      ++line_;
+      lineStart_ = position_;
+    }
+  }
+
+  /// build an error at the current position
+  [[nodiscard]] auto error(std::string_view message) const
+      -> LevelParseError {
+    return {message, line_, position_ - lineStart_ + 1};
+  }
+
+  /// build an error at the start of a token
+  [[nodiscard]] auto errorAt(std::string_view token,
+                             std::string_view message) const
+      -> LevelParseError {
+    return {message, line_,
+            static_cast<size_t>(token.data() - text_.data()) - lineStart_ + 1};
+  }
+
+private:
+  static constexpr auto isSpace(char character) noexcept -> bool {
+    return character == ' ' || character == '\t' || character == '\n' ||
+           character == '\r';
+  }
+
+  std::string_view text_;
+  size_t position_{};
+  size_t line_{1};
+  size_t lineStart_{};
+};
+
+/// replace the floor and wall layers and the enemies with a level parsed from
+/// its text
+///
+/// the text is parsed in a single pass without copying it, a mapped file can
+/// be parsed in place. The tiles and the enemies whose name is not in the
+/// catalog are skipped
+///
+/// \param[in] Text the text of the level
+/// \param[in] Catalog the catalog to look the tile and enemy names up in
+/// \param[out] Map the floor layer
+/// \param[out] MapWall the wall layer
+/// \param[out] Enemies the enemies
+/// \param[in] OnProgress called with the number of characters parsed every
+/// few thousand lines, the parsing stops when it returns false
+/// \return false if OnProgress stopped the parsing
+/// \throw LevelParseError if a line is not a tile, an enemy or the layer
+/// separator, or if a tile is outside the storableCells, the layers are left
+/// partially filled
+export auto parseLevel(std::string_view text, const Catalog &catalog,
+                       TileStore &map, TileStore &mapWall, ActorStore &enemies,
+                       const std::function<bool(size_t)> &onProgress = {})
+    -> bool {
+  const ProfileZone zone{"parseLevel"};
+
+  map.clear();
+  mapWall.clear();
+  enemies.clear();
+
+  // a tile line is more than 24 characters long, reserving for that many
+  // tiles avoids growing the stores while parsing
+  constexpr size_t minLineLength{24};
+  const auto floorSize = std::min(text.find(levelLayerSeparator), text.size());
+  map.reserve(floorSize / minLineLength);
+  mapWall.reserve((text.size() - floorSize) / minLineLength);
+
+  constexpr size_t progressLines{4096};
+  size_t lines{};
+
+  LevelTokenizer tokenizer{text};
+  // null once the tiles are parsed, the lines left are enemies
+  auto *store = &map;
+  while (!tokenizer.atEnd()) {
+    if (onProgress && ++lines % progressLines == 0 &&
+        !onProgress(tokenizer.position())) {
+      return false;
+    }
+    if (tokenizer.atLineEnd()) {
+      tokenizer.endLine();
+      continue;
+    }
+
+    const auto name = tokenizer.token(store ? "a tile name" : "an enemy name");
+    if (name == levelLayerSeparator) {
+      store = store == &map ? &mapWall : nullptr;
+      tokenizer.endLine();
+      continue;
+    }
+
+    if (store == nullptr) {
+      const SDL_FPoint pos{tokenizer.number<float>("the enemy x"),
+                           tokenizer.number<float>("the enemy y")};
+      const auto running = tokenizer.number<int>("the enemy running flag");
+      tokenizer.endLine();
+      if (auto kindId = catalog.findEnemy(name)) {
+        enemies.insert(*kindId, pos, {.running = running != 0});
+      }
+      continue;
+    }
+
+    const auto type = tokenizer.token("the tile type");
+    if (type != "static" && type != "animated") {
+      throw tokenizer.errorAt(
+          type, std::format("expected static or animated, found '{}'", type));
+    }
+    for (const auto *what : {"the source x", "the source y",
+                             "the source width", "the source height"}) {
+      tokenizer.number<float>(what);
+    }
+    const SDL_FPoint pos{tokenizer.number<float>("the tile x"),
+                         tokenizer.number<float>("the tile y")};
+    const auto cell = cellOf(pos);
+    if (!storableCells.contains(cell)) {
+      throw tokenizer.error(std::format(
+          "the tile cell {} {} is outside the storable cells", cell.x, cell.y));
+    }
+    const auto level = tokenizer.number<int>("the tile level");
+    tokenizer.endLine();
+
+    if (auto catalogId = catalog.findTile(name)) {
+      store->insert(cell, *catalogId, level != 0);
+    }
+  }
+  return true;
+}
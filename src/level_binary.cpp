@@ -0,0 +1,498 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+export module levelBinary;
+
+import actorStore;
+import catalog;
+import mappedFile;
+import profiler;
+import sprite;
+import tile;
+import tileStore;
+
+/// first bytes of a binary level file
+export constexpr std::array<char, 4> binaryLevelMagic{'L', 'V', 'L', 'B'};
+/// version of the binary level format written by saveBinaryLevel()
+export constexpr std::uint16_t binaryLevelVersion{2};
+
+/// the file formats of a level, both hold the tiles and the enemies
+export enum class LevelFormat : std::uint8_t {
+  /// written by saveLevel()
+  text,
+  /// written by saveBinaryLevel()
+  binary
+};
+
+/// number of LevelFormat values
+export constexpr std::size_t levelFormatCount{2};
+
+/// header of a binary level file
+///
+/// the file is laid out as:\n
+/// header, catalog entries, catalog names padded to 8 bytes, floor tile
+/// records, wall tile records, enemy catalog entries, enemy catalog names
+/// padded to 8 bytes, enemy records\n
+/// every value is stored in the byte order of the machine that wrote it
+export struct BinaryLevelHeader {
+  std::array<char, 4> magic;
+  std::uint16_t version;
+  /// size of the header in bytes, lets a later version extend it
+  std::uint16_t headerSize;
+  std::uint32_t catalogCount;
+  /// size of the catalog names in bytes, without the padding
+  std::uint32_t namesSize;
+  std::uint32_t floorCount;
+  std::uint32_t wallCount;
+  std::uint32_t enemyCatalogCount;
+  /// size of the enemy catalog names in bytes, without the padding
+  std::uint32_t enemyNamesSize;
+  std::uint32_t enemyCount;
+  std::uint32_t reserved;
+};
+
+/// name of a tile or enemy kind used by the records of a binary level
+export struct BinaryCatalogEntry {
+  /// offset of the name from the start of the catalog names
+  std::uint32_t nameOffset;
+  std::uint32_t nameLength;
+};
+
+/// a tile of a binary level
+export struct BinaryTileRecord {
+  /// the tile cell packed by packCell(), one of the storableCells
+  std::uint32_t cell;
+  /// index of the tile kind in the catalog entries of the file
+  std::uint16_t catalogId;
+  std::uint8_t level;
+  std::uint8_t reserved;
+};
+
+/// an enemy of a binary level
+export struct BinaryEnemyRecord {
+  /// the position of the feet of the enemy, in map pixels
+  float x;
+  float y;
+  /// index of the enemy kind in the enemy catalog entries of the file
+  std::uint16_t kindId;
+  std::uint8_t running;
+  std::uint8_t reserved;
+};
+
+static_assert(sizeof(BinaryLevelHeader) == 40);
+static_assert(sizeof(BinaryCatalogEntry) == 8);
+static_assert(sizeof(BinaryTileRecord) == 8);
+static_assert(sizeof(BinaryEnemyRecord) == 12);
+static_assert(std::is_trivially_copyable_v<BinaryLevelHeader> &&
+              std::is_trivially_copyable_v<BinaryCatalogEntry> &&
+              std::is_trivially_copyable_v<BinaryTileRecord> &&
+              std::is_trivially_copyable_v<BinaryEnemyRecord>);
+
+/// an error occured while reading a binary level
+export class LevelFormatError : public std::exception {
+public:
+  /// constructor
+  ///
+  /// \param[in] ErrorMessage the error message
+  LevelFormatError(std::string_view errorMessage)
+      : errorMessage_(errorMessage) {}
+
+  /// get the error message
+  ///
+  /// \return the error message
+  [[nodiscard]] auto what() const noexcept -> const char * override {
+    return errorMessage_.c_str();
+  }
+
+private:
+  std::string errorMessage_;
+};
+
+/// round a size up to the alignment of the tile records
+export constexpr auto padToRecord(std::size_t size) noexcept -> std::size_t {
+  constexpr auto alignment = sizeof(BinaryTileRecord);
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+/// catalog id of the tile kinds of a file which are not in the catalog,
+/// skipped by TileStore::assign()
+export constexpr auto unknownCatalogId = TileStore::freeId;
+/// kind id of the enemy kinds of a file which are not in the catalog
+export constexpr auto unknownEnemyId = std::numeric_limits<ActorKindId>::max();
+
+/// the kind names referenced by the records of a binary level or of an edit
+/// journal, read in place
+export struct CatalogTable {
+  std::span<const BinaryCatalogEntry> entries;
+  /// the names, without the padding
+  std::string_view names;
+  /// offset of the bytes following the padded names
+  std::size_t end{};
+
+  /// get the name of a kind of the file
+  [[nodiscard]] auto name(std::size_t kindId) const noexcept
+      -> std::string_view {
+    const auto &entry = entries[kindId];
+    return names.substr(entry.nameOffset, entry.nameLength);
+  }
+
+  /// match the kinds of the file to the kinds of the game by name
+  ///
+  /// \param[in] Find get the optional id of a name in the game
+  /// \param[in] UnknownId the id of the names which are not found
+  /// \return the ids of the game indexed by the ids of the file
+  template <class Id, class Find>
+  [[nodiscard]] auto match(Find find, Id unknownId) const -> std::vector<Id> {
+    std::vector<Id> ids;
+    ids.reserve(entries.size());
+    for (std::size_t index = 0; index < entries.size(); ++index) {
+      ids.push_back(find(name(index)).value_or(unknownId));
+    }
+    return ids;
+  }
+
+  /// match the tile kinds of the file to the catalog by name
+  ///
+  /// \return the catalog ids indexed by the ids of the file, unknownCatalogId
+  /// for the names which are not in the catalog
+  [[nodiscard]] auto matchTiles(const Catalog &catalog) const
+      -> std::vector<CatalogId> {
+    return match(
+        [&catalog](std::string_view name) { return catalog.findTile(name); },
+        unknownCatalogId);
+  }
+
+  /// match the enemy kinds of the file to the catalog by name
+  ///
+  /// \return the kind ids indexed by the ids of the file, unknownEnemyId for
+  /// the names which are not in the catalog
+  [[nodiscard]] auto matchEnemies(const Catalog &catalog) const
+      -> std::vector<ActorKindId> {
+    return match(
+        [&catalog](std::string_view name) { return catalog.findEnemy(name); },
+        unknownEnemyId);
+  }
+};
+
+/// point a catalog table at the bytes of a file
+///
+/// \param[in] Bytes the bytes of the file
+/// \param[in] Offset the offset of the table in the file
+/// \param[in] Count the number of catalog entries
+/// \param[in] NamesSize the size of the names without the padding
+/// \return the table, or nothing if the file is too small for it or a name
+/// is outside the names
+export auto readCatalogTable(std::span<const std::byte> bytes,
+                             std::size_t offset, std::uint32_t count,
+                             std::uint32_t namesSize)
+    -> std::optional<CatalogTable> {
+  const auto namesOffset = offset + count * sizeof(BinaryCatalogEntry);
+  const auto end = namesOffset + padToRecord(namesSize);
+  if (end > bytes.size()) {
+    return std::nullopt;
+  }
+  const CatalogTable table{
+      .entries = {reinterpret_cast<const BinaryCatalogEntry *>(bytes.data() +
+                                                               offset),
+                  count},
+      .names = {reinterpret_cast<const char *>(bytes.data() + namesOffset),
+                namesSize},
+      .end = end};
+  for (const auto &entry : table.entries) {
+    if (std::size_t{entry.nameOffset} + entry.nameLength > namesSize) {
+      return std::nullopt;
+    }
+  }
+  return table;
+}
+
+/// get the size of the names written by writeCatalogTable(), without the
+/// padding
+export template <class Kind>
+auto catalogNamesSize(std::span<const Kind> kinds) noexcept -> std::uint32_t {
+  std::size_t size{};
+  for (const auto &kind : kinds) {
+    size += kind.name().size();
+  }
+  return static_cast<std::uint32_t>(size);
+}
+
+/// write the catalog entries and the padded names of some kinds
+///
+/// \param[in] Ostream the binary stream to write the table to
+/// \param[in] Kinds the tile or enemy kinds indexed by id
+export template <class Kind>
+auto writeCatalogTable(std::ostream &ostream, std::span<const Kind> kinds)
+    -> void {
+  std::vector<BinaryCatalogEntry> entries;
+  entries.reserve(kinds.size());
+  std::string names;
+  for (const auto &kind : kinds) {
+    entries.push_back({.nameOffset = static_cast<std::uint32_t>(names.size()),
+                       .nameLength =
+                           static_cast<std::uint32_t>(kind.name().size())});
+    names += kind.name();
+  }
+  names.resize(padToRecord(names.size()), '\0');
+  ostream.write(reinterpret_cast<const char *>(entries.data()),
+                static_cast<std::streamsize>(entries.size() *
+                                             sizeof(BinaryCatalogEntry)));
+  ostream.write(names.data(), static_cast<std::streamsize>(names.size()));
+}
+
+/// a binary level file mapped in memory, its tiles are read in place
+export class MappedLevel {
+public:
+  /// constructor, map and validate a binary level file
+  ///
+  /// \param[in] Path the path of the file
+  /// \throw FileMappingError if the file can not be mapped
+  /// \throw LevelFormatError if the file is not a valid binary level
+  explicit MappedLevel(const std::filesystem::path &path) : file_{path} {
+    validate(path);
+  }
+
+  [[nodiscard]] auto getHeader() const noexcept -> const BinaryLevelHeader & {
+    return *header_;
+  }
+
+  /// get the names of the tile kinds of the file
+  [[nodiscard]] auto getCatalog() const noexcept -> const CatalogTable & {
+    return catalog_;
+  }
+
+  [[nodiscard]] auto floor() const noexcept
+      -> std::span<const BinaryTileRecord> {
+    return floor_;
+  }
+
+  [[nodiscard]] auto wall() const noexcept
+      -> std::span<const BinaryTileRecord> {
+    return wall_;
+  }
+
+  /// get the names of the enemy kinds of the file
+  [[nodiscard]] auto getEnemyCatalog() const noexcept
+      -> const CatalogTable & {
+    return enemyCatalog_;
+  }
+
+  [[nodiscard]] auto enemies() const noexcept
+      -> std::span<const BinaryEnemyRecord> {
+    return enemies_;
+  }
+
+private:
+  /// check the header and point the tables at the mapped bytes
+  auto validate(const std::filesystem::path &path) -> void;
+
+  MappedFile file_;
+
+  const BinaryLevelHeader *header_{};
+  CatalogTable catalog_;
+  std::span<const BinaryTileRecord> floor_;
+  std::span<const BinaryTileRecord> wall_;
+  CatalogTable enemyCatalog_;
+  std::span<const BinaryEnemyRecord> enemies_;
+};
+
+auto MappedLevel::validate(const std::filesystem::path &path) -> void {
+  const auto invalid = [&path](std::string_view reason) {
+    return LevelFormatError{
+        std::format("{} is not a binary level: {}", path.string(), reason)};
+  };
+
+  const auto bytes = file_.bytes();
+  if (bytes.size() < sizeof(BinaryLevelHeader)) {
+    throw invalid("file too small");
+  }
+  header_ = reinterpret_cast<const BinaryLevelHeader *>(bytes.data());
+  if (header_->magic != binaryLevelMagic) {
+    throw invalid("bad magic");
+  }
+  if (header_->version != binaryLevelVersion) {
+    throw invalid(std::format("unsupported version {}", header_->version));
+  }
+  if (header_->headerSize < sizeof(BinaryLevelHeader) ||
+      header_->headerSize % sizeof(BinaryTileRecord) != 0) {
+    throw invalid("bad header size");
+  }
+
+  const auto catalog = readCatalogTable(bytes, header_->headerSize,
+                                        header_->catalogCount,
+                                        header_->namesSize);
+  if (!catalog) {
+    throw invalid("bad catalog");
+  }
+  catalog_ = *catalog;
+
+  const auto floorOffset = catalog_.end;
+  const auto wallOffset =
+      floorOffset + header_->floorCount * sizeof(BinaryTileRecord);
+  const auto wallEnd =
+      wallOffset + header_->wallCount * sizeof(BinaryTileRecord);
+  if (wallEnd > bytes.size()) {
+    throw invalid("truncated file");
+  }
+
+  const auto enemyCatalog =
+      readCatalogTable(bytes, wallEnd, header_->enemyCatalogCount,
+                       header_->enemyNamesSize);
+  if (!enemyCatalog) {
+    throw invalid("bad enemy catalog");
+  }
+  enemyCatalog_ = *enemyCatalog;
+
+  const auto enemiesOffset = enemyCatalog_.end;
+  const auto end =
+      enemiesOffset + header_->enemyCount * sizeof(BinaryEnemyRecord);
+  if (end > bytes.size()) {
+    throw invalid("truncated file");
+  }
+
+  const auto *data = bytes.data();
+  floor_ = {reinterpret_cast<const BinaryTileRecord *>(data + floorOffset),
+            header_->floorCount};
+  wall_ = {reinterpret_cast<const BinaryTileRecord *>(data + wallOffset),
+           header_->wallCount};
+  enemies_ = {
+      reinterpret_cast<const BinaryEnemyRecord *>(data + enemiesOffset),
+      header_->enemyCount};
+
+  for (const auto records : {floor_, wall_}) {
+    for (const auto &record : records) {
+      if (record.catalogId >= catalog_.entries.size()) {
+        throw invalid("tile kind out of bounds");
+      }
+      if (!storableCells.contains(unpackCell(record.cell))) {
+        throw invalid("tile cell out of bounds");
+      }
+    }
+  }
+  for (const auto &record : enemies_) {
+    if (record.kindId >= enemyCatalog_.entries.size()) {
+      throw invalid("enemy kind out of bounds");
+    }
+  }
+}
+
+/// write a level in the binary format
+///
+/// \param[in] Ostream the binary stream to write the level to
+/// \param[in] Catalog the tile kinds indexed by catalog id
+/// \param[in] Map the floor layer
+/// \param[in] MapWall the wall layer
+/// \param[in] EnemyKinds the enemy kinds indexed by kind id
+/// \param[in] Enemies the enemies
+export auto saveBinaryLevel(std::ostream &ostream,
+                            std::span<const RendererBuilder> catalog,
+                            const TileStore &map, const TileStore &mapWall,
+                            std::span<const CharacterSprite> enemyKinds,
+                            const ActorStore &enemies) -> void {
+  const ProfileZone zone{"saveBinaryLevel"};
+
+  const BinaryLevelHeader header{
+      .magic = binaryLevelMagic,
+      .version = binaryLevelVersion,
+      .headerSize = sizeof(BinaryLevelHeader),
+      .catalogCount = static_cast<std::uint32_t>(catalog.size()),
+      .namesSize = catalogNamesSize(catalog),
+      .floorCount = static_cast<std::uint32_t>(map.size()),
+      .wallCount = static_cast<std::uint32_t>(mapWall.size()),
+      .enemyCatalogCount = static_cast<std::uint32_t>(enemyKinds.size()),
+      .enemyNamesSize = catalogNamesSize(enemyKinds),
+      .enemyCount = static_cast<std::uint32_t>(enemies.size()),
+      .reserved = 0};
+
+  const auto write = [&ostream](const auto *data, std::size_t size) {
+    ostream.write(reinterpret_cast<const char *>(data),
+                  static_cast<std::streamsize>(size));
+  };
+  write(&header, sizeof(header));
+  writeCatalogTable(ostream, catalog);
+
+  std::vector<BinaryTileRecord> records;
+  for (const auto *store : {&map, &mapWall}) {
+    records.clear();
+    records.reserve(store->size());
+    store->forEach([&](TileSlot slot) {
+      records.push_back(
+          {.cell = packCell(store->cell(slot)),
+           .catalogId = store->catalogId(slot),
+           .level = static_cast<std::uint8_t>(store->level(slot) ? 1 : 0),
+           .reserved = 0});
+    });
+    write(records.data(), records.size() * sizeof(BinaryTileRecord));
+  }
+
+  writeCatalogTable(ostream, enemyKinds);
+  std::vector<BinaryEnemyRecord> enemyRecords;
+  enemyRecords.reserve(enemies.size());
+  enemies.forEach([&](ActorSlot slot) {
+    const auto pos = enemies.position(slot);
+    enemyRecords.push_back(
+        {.x = pos.x,
+         .y = pos.y,
+         .kindId = enemies.kindId(slot),
+         .running = static_cast<std::uint8_t>(
+             enemies.animation(slot).running ? 1 : 0),
+         .reserved = 0});
+  });
+  write(enemyRecords.data(), enemyRecords.size() * sizeof(BinaryEnemyRecord));
+}
+
+/// replace the floor and wall layers and the enemies with a binary level
+///
+/// the tile and enemy kinds of the file are matched to the catalog by name,
+/// the tiles and the enemies whose name is not in the catalog are skipped.
+/// The tile records, validated when mapped, fill the layers in bulk
+///
+/// \param[in] Level the mapped binary level
+/// \param[in] Catalog the catalog to look the tile and enemy names up in
+/// \param[out] Map the floor layer
+/// \param[out] MapWall the wall layer
+/// \param[out] Enemies the enemies
+export auto loadBinaryLevel(const MappedLevel &level, const Catalog &catalog,
+                            TileStore &map, TileStore &mapWall,
+                            ActorStore &enemies) -> void {
+  const ProfileZone zone{"loadBinaryLevel"};
+
+  const auto fileIds = level.getCatalog().matchTiles(catalog);
+
+  const auto addTiles = [&fileIds](TileStore &store,
+                                   std::span<const BinaryTileRecord> records) {
+    store.assign(records, [&fileIds](const BinaryTileRecord &record) {
+      return TileStore::PackedTile{.cell = record.cell,
+                                   .catalogId = fileIds[record.catalogId],
+                                   .level = record.level != 0};
+    });
+  };
+  addTiles(map, level.floor());
+  addTiles(mapWall, level.wall());
+
+  const auto enemyIds = level.getEnemyCatalog().matchEnemies(catalog);
+  enemies.clear();
+  enemies.reserve(level.enemies().size());
+  for (const auto &record : level.enemies()) {
+    if (const auto kindId = enemyIds[record.kindId]; kindId != unknownEnemyId) {
+      enemies.insert(kindId, {record.x, record.y},
+                     {.running = record.running != 0});
+    }
+  }
+}
@@ -0,0 +1,264 @@
+module;
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module levelLoader;
+
+import actorStore;
+import catalog;
+import chunk;
+import editJournal;
+import grid;
+import level;
+import levelBinary;
+import mappedFile;
+import profiler;
+import tile;
+import tileStore;
+
+/// the layers and the enemies of a level and their render indices
+export struct LevelData {
+  TileStore map;
+  TileStore mapWall;
+  ActorStore enemies;
+  /// map tiles grouped by chunk
+  FloorChunks floorChunks;
+  /// mapWall tiles indexed by cell and sorted by wallSortKey()
+  SpatialIndex<TileSlot> wallIndex;
+  /// the format of the file the level was loaded from
+  LevelFormat format{LevelFormat::text};
+};
+
+/// get the key used to sort a wall tile with the other wall tiles and the
+/// characters
+export auto wallSortKey(const TileStore &mapWall,
+                        std::span<const RendererBuilder> catalog,
+                        TileSlot slot) noexcept -> float {
+  const auto &kind = catalog[mapWall.catalogId(slot)];
+  return mapWall.position(slot).y +
+         (mapWall.level(slot) ? kind.getSourceRect().h : 0);
+}
+
+/// rebuild the floor chunks and the wall index from the layers
+///
+/// no texture is created, the chunks are baked when rendered, so the indices
+/// can be built off the render thread
+export auto indexLevel(std::span<const RendererBuilder> catalog,
+                       const TileStore &map, const TileStore &mapWall,
+                       FloorChunks &floorChunks,
+                       SpatialIndex<TileSlot> &wallIndex) -> void {
+  floorChunks.clear();
+  map.forEach([&](TileSlot slot) {
+    floorChunks.insert(map.cell(slot), slot,
+                       !catalog[map.catalogId(slot)].isBakeable());
+  });
+
+  wallIndex.clear();
+  mapWall.forEach([&](TileSlot slot) {
+    wallIndex.append(mapWall.cell(slot), wallSortKey(mapWall, catalog, slot),
+                     slot);
+  });
+  wallIndex.sort();
+}
+
+/// load a text or binary level on a background thread
+///
+/// the level and its indices are built off the render thread, the game swaps
+/// them in with takeLoaded() at a frame boundary
+export class AsyncLevelLoader {
+public:
+  /// start loading a level, cancelling the load in progress
+  ///
+  /// \param[in] Path the path of the text level
+  /// \param[in] Catalog the catalog to look the tile and enemy names up in,
+  /// it must not change until the load ends
+  /// \param[in] Journals the edit journals replayed in order on the level,
+  /// the missing ones are skipped
+  auto start(std::filesystem::path path, const Catalog &catalog,
+             std::vector<std::filesystem::path> journals = {}) -> void;
+
+  /// start loading a binary level, cancelling the load in progress
+  ///
+  /// \param[in] Path the path of the binary level
+  /// \param[in] Catalog the catalog to look the tile names up in, it must
+  /// not change until the load ends
+  auto startBinary(std::filesystem::path path, const Catalog &catalog)
+      -> void;
+
+  /// stop the load in progress and drop its result
+  auto cancel() -> void;
+
+  /// check if a level is being loaded
+  [[nodiscard]] auto isLoading() const noexcept -> bool {
+    return status_.load(std::memory_order_acquire) == Status::loading;
+  }
+
+  /// get the progress of the load in progress, from 0 to 1
+  [[nodiscard]] auto getProgress() const noexcept -> float {
+    return progress_.load(std::memory_order_relaxed);
+  }
+
+  /// get the loaded level, once
+  auto takeLoaded() -> std::optional<LevelData>;
+
+  /// get the error of the last load, once
+  auto takeError() -> std::optional<std::string>;
+
+private:
+  enum class Status : std::uint8_t { idle, loading, loaded, failed };
+
+  /// cancel the load in progress and run a load on the worker thread
+  template <class Load> auto launch(Load load) -> void {
+    cancel();
+    progress_.store(0, std::memory_order_relaxed);
+    status_.store(Status::loading, std::memory_order_relaxed);
+    worker_ = std::jthread{std::move(load)};
+  }
+
+  /// load a text level on the worker thread
+  auto load(const std::stop_token &stopToken,
+            const std::filesystem::path &path, const Catalog &catalog,
+            std::span<const std::filesystem::path> journals) -> void;
+
+  /// load a binary level on the worker thread
+  auto loadBinary(const std::stop_token &stopToken,
+                  const std::filesystem::path &path, const Catalog &catalog)
+      -> void;
+
+  /// share of the progress taken by the parsing, the rest is the indexing
+  static constexpr float parseShare{0.9};
+
+  std::atomic<Status> status_{Status::idle};
+  std::atomic<float> progress_{};
+
+  /// written by the worker before it publishes the loaded or failed status
+  std::optional<LevelData> loaded_;
+  std::string error_;
+
+  /// last member, the worker is stopped before the other members go away
+  std::jthread worker_;
+};
+
+auto AsyncLevelLoader::start(std::filesystem::path path,
+                             const Catalog &catalog,
+                             std::vector<std::filesystem::path> journals)
+    -> void {
+  launch([this, path = std::move(path), &catalog,
+          journals = std::move(journals)](const std::stop_token &stopToken) {
+    load(stopToken, path, catalog, journals);
+  });
+}
+
+auto AsyncLevelLoader::startBinary(std::filesystem::path path,
+                                   const Catalog &catalog) -> void {
+  launch([this, path = std::move(path),
+          &catalog](const std::stop_token &stopToken) {
+    loadBinary(stopToken, path, catalog);
+  });
+}
+
+auto AsyncLevelLoader::cancel() -> void {
+  if (worker_.joinable()) {
+    worker_.request_stop();
+    worker_.join();
+  }
+  loaded_.reset();
+  status_.store(Status::idle, std::memory_order_relaxed);
+}
+
+auto AsyncLevelLoader::takeLoaded() -> std::optional<LevelData> {
+  if (status_.load(std::memory_order_acquire) != Status::loaded) {
+    return std::nullopt;
+  }
+  worker_.join();
+  status_.store(Status::idle, std::memory_order_relaxed);
+  return std::exchange(loaded_, std::nullopt);
+}
+
+auto AsyncLevelLoader::takeError() -> std::optional<std::string> {
+  if (status_.load(std::memory_order_acquire) != Status::failed) {
+    return std::nullopt;
+  }
+  worker_.join();
+  status_.store(Status::idle, std::memory_order_relaxed);
+  return std::exchange(error_, {});
+}
+
+auto AsyncLevelLoader::load(const std::stop_token &stopToken,
+                            const std::filesystem::path &path,
+                            const Catalog &catalog,
+                            std::span<const std::filesystem::path> journals)
+    -> void {
+  const ProfileZone zone{"AsyncLevelLoader::load"};
+  try {
+    const MappedFile file{path};
+    const auto text = file.text();
+
+    LevelData level;
+    const auto parsed =
+        parseLevel(text, catalog, level.map, level.mapWall, level.enemies,
+                   [&](std::size_t position) {
+                     progress_.store(parseShare *
+                                         static_cast<float>(position) /
+                                         static_cast<float>(text.size()),
+                                     std::memory_order_relaxed);
+                     return !stopToken.stop_requested();
+                   });
+    if (!parsed) {
+      return;
+    }
+    for (const auto &journal : journals) {
+      replayJournal(journal, catalog, level.map, level.mapWall);
+    }
+    progress_.store(parseShare, std::memory_order_relaxed);
+
+    indexLevel(catalog.tiles(), level.map, level.mapWall, level.floorChunks,
+               level.wallIndex);
+    progress_.store(1, std::memory_order_relaxed);
+
+    loaded_ = std::move(level);
+    status_.store(Status::loaded, std::memory_order_release);
+  } catch (const std::exception &error) {
+    error_ = error.what();
+    status_.store(Status::failed, std::memory_order_release);
+  }
+}
+
+auto AsyncLevelLoader::loadBinary(const std::stop_token &stopToken,
+                                  const std::filesystem::path &path,
+                                  const Catalog &catalog) -> void {
+  const ProfileZone zone{"AsyncLevelLoader::loadBinary"};
+  try {
+    const MappedLevel file{path};
+
+    // the tiles are copied in one pass, the progress only moves between the
+    // copy and the indexing
+    LevelData level{.format = LevelFormat::binary};
+    loadBinaryLevel(file, catalog, level.map, level.mapWall, level.enemies);
+    if (stopToken.stop_requested()) {
+      return;
+    }
+    progress_.store(parseShare, std::memory_order_relaxed);
+
+    indexLevel(catalog.tiles(), level.map, level.mapWall, level.floorChunks,
+               level.wallIndex);
+    progress_.store(1, std::memory_order_relaxed);
+
+    loaded_ = std::move(level);
+    status_.store(Status::loaded, std::memory_order_release);
+  } catch (const std::exception &error) {
+    error_ = error.what();
+    status_.store(Status::failed, std::memory_order_release);
+  }
+}
@@ -0,0 +1,252 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <ios>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+
+export module levelSaver;
+
+import actorStore;
+import level;
+import levelBinary;
+import profiler;
+import sprite;
+import tile;
+import tileStore;
+
+/// save text and binary levels on a background thread
+///
+/// save() only copies the layers and the enemies, a writer thread serializes
+/// the copy to a temporary file then renames it over the level, so the level
+/// file is either the previous or the new level, never a partial one. A save
+/// requested while writing replaces the one of the same format waiting to be
+/// written
+export class AsyncLevelSaver {
+public:
+  AsyncLevelSaver()
+      : writer_{[this](const std::stop_token &stopToken) { run(stopToken); }} {
+  }
+
+  AsyncLevelSaver(const AsyncLevelSaver &) = delete;
+  AsyncLevelSaver(AsyncLevelSaver &&) = delete;
+  auto operator=(const AsyncLevelSaver &) -> AsyncLevelSaver & = delete;
+  auto operator=(AsyncLevelSaver &&) -> AsyncLevelSaver & = delete;
+
+  /// the destructor waits for the requested save to be written
+  ~AsyncLevelSaver() = default;
+
+  /// request to save a level
+  ///
+  /// \param[in] Path the path of the text level
+  /// \param[in] Catalog the tile kinds indexed by catalog id, it must not
+  /// change until the save is written
+  /// \param[in] Map the floor layer, copied
+  /// \param[in] MapWall the wall layer, copied
+  /// \param[in] EnemyKinds the enemy kinds indexed by kind id, it must not
+  /// change until the save is written
+  /// \param[in] Enemies the enemies, copied
+  /// \param[in] OnWritten called on the writer thread once the level file is
+  /// replaced, not called if the save fails or is replaced by a later one
+  auto save(std::filesystem::path path,
+            std::span<const RendererBuilder> catalog, const TileStore &map,
+            const TileStore &mapWall,
+            std::span<const CharacterSprite> enemyKinds,
+            const ActorStore &enemies, std::function<void()> onWritten = {})
+      -> void;
+
+  /// request to save a level in the binary format
+  ///
+  /// \param[in] Path the path of the binary level
+  /// \param[in] Catalog the tile kinds indexed by catalog id, it must not
+  /// change until the save is written
+  /// \param[in] Map the floor layer, copied
+  /// \param[in] MapWall the wall layer, copied
+  /// \param[in] EnemyKinds the enemy kinds indexed by kind id, it must not
+  /// change until the save is written
+  /// \param[in] Enemies the enemies, copied
+  auto saveBinary(std::filesystem::path path,
+                  std::span<const RendererBuilder> catalog,
+                  const TileStore &map, const TileStore &mapWall,
+                  std::span<const CharacterSprite> enemyKinds,
+                  const ActorStore &enemies) -> void;
+
+  /// check if a save is waiting or being written
+  [[nodiscard]] auto isSaving() -> bool {
+    const std::scoped_lock lock{mutex_};
+    return hasPending() || writing_;
+  }
+
+  /// wait until every requested save is written
+  auto wait() -> void {
+    std::unique_lock lock{mutex_};
+    changed_.wait(lock, [this] { return !hasPending() && !writing_; });
+  }
+
+  /// get the error of the last failed save, once
+  auto takeError() -> std::optional<std::string> {
+    const std::scoped_lock lock{mutex_};
+    return std::exchange(error_, std::nullopt);
+  }
+
+private:
+  /// a copy of the level to write
+  struct Snapshot {
+    LevelFormat format{};
+    std::filesystem::path path;
+    std::span<const RendererBuilder> catalog;
+    TileStore map;
+    TileStore mapWall;
+    std::span<const CharacterSprite> enemyKinds;
+    ActorStore enemies;
+    std::function<void()> onWritten;
+  };
+
+  /// check if a save is waiting to be written, with the mutex held
+  [[nodiscard]] auto hasPending() const noexcept -> bool {
+    return std::ranges::any_of(hasPending_, std::identity{});
+  }
+
+  /// write the requested saves until stopped
+  auto run(const std::stop_token &stopToken) -> void;
+
+  /// write a snapshot to a temporary file and rename it over the level
+  static auto write(const Snapshot &snapshot) -> void;
+
+  std::mutex mutex_;
+  std::condition_variable_any changed_;
+  /// the saves waiting to be written indexed by format, their memory is
+  /// reused by the next ones
+  std::array<Snapshot, levelFormatCount> pending_;
+  std::array<bool, levelFormatCount> hasPending_{};
+  bool writing_{};
+  std::optional<std::string> error_;
+
+  /// last member, the writer is stopped before the other members go away
+  std::jthread writer_;
+};
+
+auto AsyncLevelSaver::save(std::filesystem::path path,
+                           std::span<const RendererBuilder> catalog,
+                           const TileStore &map, const TileStore &mapWall,
+                           std::span<const CharacterSprite> enemyKinds,
+                           const ActorStore &enemies,
+                           std::function<void()> onWritten) -> void {
+  const ProfileZone zone{"AsyncLevelSaver::save"};
+  {
+    const std::scoped_lock lock{mutex_};
+    auto &pending = pending_[static_cast<size_t>(LevelFormat::text)];
+    pending.format = LevelFormat::text;
+    pending.path = std::move(path);
+    pending.catalog = catalog;
+    // copy assignment reuses the memory of the previous snapshots
+    pending.map = map;
+    pending.mapWall = mapWall;
+    pending.enemyKinds = enemyKinds;
+    pending.enemies = enemies;
+    pending.onWritten = std::move(onWritten);
+    hasPending_[static_cast<size_t>(LevelFormat::text)] = true;
+  }
+  changed_.notify_all();
+}
+
+auto AsyncLevelSaver::saveBinary(std::filesystem::path path,
+                                 std::span<const RendererBuilder> catalog,
+                                 const TileStore &map, const TileStore &mapWall,
+                                 std::span<const CharacterSprite> enemyKinds,
+                                 const ActorStore &enemies) -> void {
+  const ProfileZone zone{"AsyncLevelSaver::saveBinary"};
+  {
+    const std::scoped_lock lock{mutex_};
+    auto &pending = pending_[static_cast<size_t>(LevelFormat::binary)];
+    pending.format = LevelFormat::binary;
+    pending.path = std::move(path);
+    pending.catalog = catalog;
+    pending.map = map;
+    pending.mapWall = mapWall;
+    pending.enemyKinds = enemyKinds;
+    pending.enemies = enemies;
+    // the snapshots are swapped with the written ones, drop the callback a
+    // text save left
+    pending.onWritten = {};
+    hasPending_[static_cast<size_t>(LevelFormat::binary)] = true;
+  }
+  changed_.notify_all();
+}
+
+auto AsyncLevelSaver::run(const std::stop_token &stopToken) -> void {
+  Snapshot snapshot;
+  while (true) {
+    {
+      std::unique_lock lock{mutex_};
+      // a stop request still lets the pending save be written
+      if (!changed_.wait(lock, stopToken, [this] { return hasPending(); })) {
+        return;
+      }
+      const auto index = static_cast<size_t>(
+          std::ranges::find(hasPending_, true) - hasPending_.begin());
+      std::swap(snapshot, pending_[index]);
+      hasPending_[index] = false;
+      writing_ = true;
+    }
+
+    std::optional<std::string> error;
+    try {
+      write(snapshot);
+      if (snapshot.onWritten) {
+        snapshot.onWritten();
+      }
+    } catch (const std::exception &exception) {
+      error = exception.what();
+    }
+
+    {
+      const std::scoped_lock lock{mutex_};
+      writing_ = false;
+      if (error) {
+        error_ = std::move(error);
+      }
+    }
+    changed_.notify_all();
+  }
+}
+
+auto AsyncLevelSaver::write(const Snapshot &snapshot) -> void {
+  const ProfileZone zone{"AsyncLevelSaver::write"};
+
+  auto temporaryPath = snapshot.path;
+  temporaryPath += ".tmp";
+  {
+    const auto binary = snapshot.format == LevelFormat::binary;
+    std::ofstream file{temporaryPath,
+                       binary ? std::ios::binary | std::ios::trunc
+                              : std::ios::trunc};
+    if (binary) {
+      saveBinaryLevel(file, snapshot.catalog, snapshot.map, snapshot.mapWall,
+                      snapshot.enemyKinds, snapshot.enemies);
+    } else {
+      saveLevel(file, snapshot.catalog, snapshot.map, snapshot.mapWall,
+                snapshot.enemyKinds, snapshot.enemies);
+    }
+    file.close();
+    if (!file) {
+      throw std::runtime_error{
+          std::format("can not write {}", temporaryPath.string())};
+    }
+  }
+  std::filesystem::rename(temporaryPath, snapshot.path);
+}
@@ -0,0 +1,133 @@
+module;
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#else
+#include <fstream>
+#define MAPPED_FILE_MMAP 0
+#endif
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module mappedFile;
+
+/// an error occured while mapping a file
+export class FileMappingError : public std::exception {
+public:
+  /// constructor
+  ///
+  /// \param[in] ErrorMessage the error message
+  FileMappingError(std::string_view errorMessage)
+      : errorMessage_(errorMessage) {}
+
+  /// get the error message
+  ///
+  /// \return the error message
+  [[nodiscard]] auto what() const noexcept -> const char * override {
+    return errorMessage_.c_str();
+  }
+
+private:
+  std::string errorMessage_;
+};
+
+/// a read only file mapped in memory
+///
+/// the file is mapped with mmap when available, read in a buffer otherwise
+export class MappedFile {
+public:
+  /// constructor
+  ///
+  /// \param[in] Path the path of the file
+  /// \throw FileMappingError if the file can not be mapped
+  explicit MappedFile(const std::filesystem::path &path);
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept
+      : bytes_{std::exchange(other.bytes_, {})},
+#if MAPPED_FILE_MMAP
+        mapping_{std::exchange(other.mapping_, MAP_FAILED)}
+#else
+        buffer_{std::move(other.buffer_)}
+#endif
+  {
+  }
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
+  auto operator=(MappedFile &&) -> MappedFile & = delete;
+
+  ~MappedFile();
+
+  /// get the content of the file
+  [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+    return bytes_;
+  }
+
+  /// get the content of the file as text
+  [[nodiscard]] auto text() const noexcept -> std::string_view {
+    return {reinterpret_cast<const char *>(bytes_.data()), bytes_.size()};
+  }
+
+private:
+  std::span<const std::byte> bytes_;
+#if MAPPED_FILE_MMAP
+  void *mapping_{MAP_FAILED};
+#else
+  std::vector<std::byte> buffer_;
+#endif
+};
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+#if MAPPED_FILE_MMAP
+  const auto file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw FileMappingError{std::format("can not open {}", path.string())};
+  }
+  struct stat fileStat{};
+  if (::fstat(file, &fileStat) != 0) {
+    ::close(file);
+    throw FileMappingError{std::format("can not read {}", path.string())};
+  }
+  const auto size = static_cast<std::size_t>(fileStat.st_size);
+  if (size == 0) {
+    // mmap refuses empty mappings, an empty file has no content to map
+    ::close(file);
+    return;
+  }
+  mapping_ = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+  if (mapping_ == MAP_FAILED) {
+    throw FileMappingError{std::format("can not map {}", path.string())};
+  }
+  bytes_ = {static_cast<const std::byte *>(mapping_), size};
+#else
+  std::ifstream file{path, std::ios::binary | std::ios::ate};
+  if (!file) {
+    throw FileMappingError{std::format("can not open {}", path.string())};
+  }
+  buffer_.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(buffer_.data()),
+            static_cast<std::streamsize>(buffer_.size()));
+  bytes_ = buffer_;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if MAPPED_FILE_MMAP
+  if (mapping_ != MAP_FAILED) {
+    ::munmap(mapping_, bytes_.size());
+  }
+#endif
+}
@@ -0,0 +1,227 @@
+module;
+
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#ifndef GAME_PROFILING
+#define GAME_PROFILING 0
+#endif
+
+export module profiler;
+
+/// whether the profiling zones are recorded, set by the GAME_PROFILING CMake
+/// option, the zones compile to nothing when disabled
+export constexpr bool profilingEnabled{GAME_PROFILING != 0};
+
+/// a zone recorded by a thread
+struct ZoneRecord {
+  const char *name;
+  Uint64 start;
+  Uint64 end;
+};
+
+/// ring buffer of the last zones recorded by a thread
+///
+/// only the owning thread writes, the records are published by the release
+/// store of head_ so a dump can read them without locking. head_ also acts
+/// as the sequence of a seqlock, a dump drops the records the owning thread
+/// may have started to overwrite while they were copied
+class ThreadZones {
+public:
+  static constexpr size_t capacity{1 << 14};
+
+  explicit ThreadZones(size_t threadIndex) noexcept
+      : threadIndex_{threadIndex} {}
+
+  auto push(const ZoneRecord &record) noexcept -> void {
+    const auto head = head_.load(std::memory_order_relaxed);
+    // a dump reading the overwritten record then sees the head_ of the
+    // previous push, which tells it the record is reused
+    std::atomic_thread_fence(std::memory_order_release);
+    auto &slot = records_[head % capacity];
+    slot.name.store(record.name, std::memory_order_relaxed);
+    slot.start.store(record.start, std::memory_order_relaxed);
+    slot.end.store(record.end, std::memory_order_relaxed);
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  /// write the recorded zones as chrome trace events
+  ///
+  /// the zones recorded while the dump runs may be missing, the dump is
+  /// meant to be taken on demand, not to be exact
+  auto dump(std::ostream &ostream, bool &first) const -> void {
+    const auto head = head_.load(std::memory_order_acquire);
+    const auto begin = head - std::min<Uint64>(head, capacity);
+    std::vector<ZoneRecord> records;
+    records.reserve(head - begin);
+    for (auto index = begin; index < head; ++index) {
+      const auto &slot = records_[index % capacity];
+      records.push_back({.name = slot.name.load(std::memory_order_relaxed),
+                         .start = slot.start.load(std::memory_order_relaxed),
+                         .end = slot.end.load(std::memory_order_relaxed)});
+    }
+
+    // the push of a record overwrites the one capacity records before it,
+    // the records up to that one may be torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const auto written = head_.load(std::memory_order_relaxed);
+    const auto valid = std::max(
+        begin, written >= capacity ? written - capacity + 1 : Uint64{});
+    for (auto index = valid; index < head; ++index) {
+      const auto &record = records[index - begin];
+      ostream << (first ? "" : ",\n")
+              << std::format(R"({{"name":"{}","ph":"X","ts":{:.3f},)"
+                             R"("dur":{:.3f},"pid":0,"tid":{}}})",
+                             record.name,
+                             static_cast<double>(record.start) / nsPerUs,
+                             static_cast<double>(record.end - record.start) /
+                                 nsPerUs,
+                             threadIndex_);
+      first = false;
+    }
+  }
+
+private:
+  static constexpr double nsPerUs{1'000};
+
+  /// a ZoneRecord read while its owning thread may write it
+  struct Slot {
+    std::atomic<const char *> name;
+    std::atomic<Uint64> start;
+    std::atomic<Uint64> end;
+  };
+
+  std::array<Slot, capacity> records_{};
+  std::atomic<Uint64> head_{};
+  size_t threadIndex_;
+};
+
+/// the ring buffers of every thread that recorded a zone
+///
+/// the buffer of an exited thread is reused by the next thread recording a
+/// zone, along with its thread id in the trace, so the short lived threads
+/// do not add a buffer each
+class ZoneRegistry {
+public:
+  static auto instance() -> ZoneRegistry & {
+    static ZoneRegistry registry;
+    return registry;
+  }
+
+  /// get the ring buffer of the calling thread, taken on the first call of
+  /// each thread
+  static auto threadZones() -> ThreadZones & {
+    thread_local const Lease lease;
+    return lease.zones();
+  }
+
+  auto dump(std::ostream &ostream) -> void {
+    const std::scoped_lock lock{mutex_};
+    ostream << "{\"traceEvents\":[\n";
+    bool first{true};
+    for (const auto &zones : threads_) {
+      zones->dump(ostream, first);
+    }
+    ostream << "\n]}\n";
+  }
+
+private:
+  /// the ring buffer of a thread, given back when the thread exits
+  class Lease {
+  public:
+    Lease() : zones_{instance().acquire()} {}
+
+    Lease(const Lease &) = delete;
+    Lease(Lease &&) = delete;
+    auto operator=(const Lease &) -> Lease & = delete;
+    auto operator=(Lease &&) -> Lease & = delete;
+
+    ~Lease() { instance().release(zones_); }
+
+    [[nodiscard]] auto zones() const noexcept -> ThreadZones & {
+      return *zones_;
+    }
+
+  private:
+    ThreadZones *zones_;
+  };
+
+  /// get a released ring buffer, or a new one if every buffer is used
+  auto acquire() -> ThreadZones * {
+    const std::scoped_lock lock{mutex_};
+    if (!released_.empty()) {
+      auto *zones = released_.back();
+      released_.pop_back();
+      return zones;
+    }
+    return threads_
+        .emplace_back(std::make_unique<ThreadZones>(threads_.size()))
+        .get();
+  }
+
+  /// give back the ring buffer of an exiting thread, its zones stay dumped
+  auto release(ThreadZones *zones) -> void {
+    const std::scoped_lock lock{mutex_};
+    released_.push_back(zones);
+  }
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadZones>> threads_;
+  /// the buffers of the exited threads, reused first
+  std::vector<ThreadZones *> released_;
+};
+
+/// record the time spent in a scope
+///
+/// \code
+/// ProfileZone zone{"Game::render"};
+/// \endcode
+export class ProfileZone {
+public:
+  /// constructor
+  ///
+  /// \param[in] Name the zone name, it has to outlive the program
+  explicit ProfileZone(const char *name) noexcept {
+    if constexpr (profilingEnabled) {
+      name_ = name;
+      start_ = SDL_GetTicksNS();
+    }
+  }
+
+  ProfileZone(const ProfileZone &) = delete;
+  ProfileZone(ProfileZone &&) = delete;
+  auto operator=(const ProfileZone &) -> ProfileZone & = delete;
+  auto operator=(ProfileZone &&) -> ProfileZone & = delete;
+
+  ~ProfileZone() {
+    if constexpr (profilingEnabled) {
+      ZoneRegistry::threadZones().push(
+          {.name = name_, .start = start_, .end = SDL_GetTicksNS()});
+    }
+  }
+
+private:
+  const char *name_{};
+  Uint64 start_{};
+};
+
+/// write the zones recorded by every thread in the chrome trace format
+///
+/// the output can be opened with chrome://tracing or ui.perfetto.dev
+export auto dumpChromeTrace(std::ostream &ostream) -> void {
+  if constexpr (profilingEnabled) {
+    ZoneRegistry::instance().dump(ostream);
+  } else {
+    ostream << "{\"traceEvents\":[]}\n";
+  }
+}
@@ -3,6 +3,8 @@ module;
 #include "backends/imgui_impl_sdl3.h"
 #include "backends/imgui_impl_sdlrenderer3.h"
 
+#include "SDL3/SDL_hints.h"
+#include "SDL3/SDL_init.h"
 #include "SDL3/SDL_pixels.h"
 #include "SDL3/SDL_render.h"
 #include "SDL3/SDL_video.h"
@@ -13,6 +15,9 @@ module;
 #include <istream>
 #include <memory>
 #include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
 
 export module sdlHelpers;
 
@@ -91,6 +96,30 @@ private:
   std::string errorMessage_; ///< the error message
 };
 
+/// initialize SDL for its lifetime
+export class SdlContext {
+public:
+  /// constructor
+  ///
+  /// \param[in] Flags the SDL subsystems to initialize
+  /// \param[in] VideoDriver the video driver to use, nullptr to let SDL choose
+  explicit SdlContext(SDL_InitFlags flags, const char *videoDriver = nullptr) {
+    if (videoDriver != nullptr) {
+      SDL_SetHint(SDL_HINT_VIDEO_DRIVER, videoDriver);
+    }
+    if (!SDL_Init(flags)) {
+      throw InitError{std::format("SDL_Init(): {}", SDL_GetError())};
+    }
+  }
+
+  SdlContext(const SdlContext &) = delete;
+  SdlContext(SdlContext &&) = delete;
+  auto operator=(const SdlContext &) -> SdlContext & = delete;
+  auto operator=(SdlContext &&) -> SdlContext & = delete;
+
+  ~SdlContext() noexcept { SDL_Quit(); }
+};
+
 export class SdlRenderer {
   friend class SdlWindow;
 
@@ -122,6 +151,40 @@ public:
     return texture;
   }
 
+  /// create a texture that can be used as a render target
+  ///
+  /// the texture is transparent where nothing is rendered to it and is blended
+  /// when rendered
+  ///
+  /// \param[in] Size the size of the texture in pixels
+  [[nodiscard]] auto createTargetTexture(const SDL_Point &size) const
+      -> SdlTexturePtr {
+    SdlTexturePtr texture = {SDL_CreateTexture(renderer_,
+                                               SDL_PIXELFORMAT_RGBA8888,
+                                               SDL_TEXTUREACCESS_TARGET,
+                                               size.x, size.y),
+                             SDL_DestroyTexture};
+    if (!texture) {
+      throw TextureLoadingError{
+          std::format("SDL_CreateTexture(): {}", SDL_GetError())};
+    }
+
+    SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture.get(), SDL_SCALEMODE_NEAREST);
+    return texture;
+  }
+
+  /// render to a texture created by createTargetTexture() instead of the
+  /// window
+  auto setRenderTarget(const SdlTexturePtr &texture) const noexcept -> void {
+    SDL_SetRenderTarget(renderer_, texture.get());
+  }
+
+  /// render to the window again
+  auto resetRenderTarget() const noexcept -> void {
+    SDL_SetRenderTarget(renderer_, nullptr);
+  }
+
   auto setRenderDrawColor(const SDL_Color &color) const noexcept -> void {
     SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
   }
@@ -138,13 +201,35 @@ public:
                             SDL_FlipMode flipMode) const noexcept -> void {
     SDL_RenderTextureRotated(renderer_, texture.get(), &sourceRect, &destRect,
                              angle, &center, flipMode);
+    ++drawCalls_;
   }
 
   auto renderTexture(const SdlTexturePtr &texture, const SDL_FRect &sourceRect,
                      const SDL_FRect &destRect) const noexcept -> void {
     SDL_RenderTexture(renderer_, texture.get(), &sourceRect, &destRect);
+    ++drawCalls_;
   }
 
+  /// render a list of textured triangles in a single draw call
+  ///
+  /// \param[in] Texture the texture used by every triangle
+  /// \param[in] Vertices the triangles vertices
+  /// \param[in] Indices the vertices indices, three per triangle
+  auto renderGeometry(SDL_Texture *texture,
+                      std::span<const SDL_Vertex> vertices,
+                      std::span<const int> indices) const noexcept -> void {
+    SDL_RenderGeometry(renderer_, texture, vertices.data(),
+                       static_cast<int>(vertices.size()), indices.data(),
+                       static_cast<int>(indices.size()));
+    ++drawCalls_;
+  }
+
+  /// get the number of draw calls issued since the last reset
+  [[nodiscard]] auto drawCalls() const noexcept -> size_t {
+    return drawCalls_;
+  }
+  auto resetDrawCalls() noexcept -> void { drawCalls_ = 0; }
+
   auto renderPresent() const noexcept -> void { SDL_RenderPresent(renderer_); }
 
   auto imguiRenderDrawData() const noexcept -> void {
@@ -157,8 +242,120 @@ private:
   }
 
   SDL_Renderer *renderer_;
+  /// draw calls issued since the last reset, only used for statistics
+  mutable size_t drawCalls_{};
+};
+
+/// accumulate textured quads and submit them with SDL_RenderGeometry
+///
+/// quads are grouped by texture: adding a quad with another texture, or
+/// calling flush(), submits every pending quad in a single draw call. The blend
+/// state is carried by the texture so one batch per texture is enough.
+export class SpriteBatch {
+public:
+  /// constructor
+  ///
+  /// \param[in] Renderer the renderer used to submit the quads, it has to
+  /// outlive the batch
+  explicit SpriteBatch(const SdlRenderer &renderer) noexcept
+      : renderer_{&renderer} {}
+
+  SpriteBatch(const SpriteBatch &) = delete;
+  SpriteBatch(SpriteBatch &&) = delete;
+  auto operator=(const SpriteBatch &) -> SpriteBatch & = delete;
+  auto operator=(SpriteBatch &&) -> SpriteBatch & = delete;
+  ~SpriteBatch() = default;
+
+  /// add a textured quad to the batch
+  ///
+  /// \param[in] Texture the texture to get the sprite from
+  /// \param[in] SourceRect the sprite area in the texture
+  /// \param[in] DestRect the area on the screen to render the sprite to
+  /// \param[in] FlipMode whether the sprite has to be mirrored
+  auto addQuad(const SdlTexturePtr &texture, const SDL_FRect &sourceRect,
+               const SDL_FRect &destRect, SDL_FlipMode flipMode = SDL_FLIP_NONE)
+      -> void;
+
+  /// submit the pending quads
+  auto flush() noexcept -> void;
+
+  /// transformation applied to the quads destination
+  struct View {
+    /// the destination point rendered to the render target (0, 0)
+    SDL_FPoint origin{};
+    /// the render target pixels per destination pixel
+    float scale{1};
+  };
+
+  /// set the transformation applied to the quads added from now on
+  auto setView(const View &view) noexcept -> void { view_ = view; }
+  [[nodiscard]] auto getView() const noexcept -> View { return view_; }
+
+  /// get the number of quads waiting to be submitted
+  [[nodiscard]] auto pendingQuads() const noexcept -> size_t {
+    return vertices_.size() / verticesPerQuad;
+  }
+
+private:
+  static constexpr size_t verticesPerQuad{4};
+
+  const SdlRenderer *renderer_;
+  /// the texture of the pending quads
+  SDL_Texture *texture_{};
+  /// the size of texture_, used to normalize the texture coordinates
+  SDL_FPoint textureSize_{1, 1};
+  View view_{};
+
+  std::vector<SDL_Vertex> vertices_;
+  std::vector<int> indices_;
 };
 
+auto SpriteBatch::addQuad(const SdlTexturePtr &texture,
+                          const SDL_FRect &sourceRect,
+                          const SDL_FRect &destRect, SDL_FlipMode flipMode)
+    -> void {
+  if (texture.get() != texture_) {
+    flush();
+    texture_ = texture.get();
+    SDL_GetTextureSize(texture_, &textureSize_.x, &textureSize_.y);
+  }
+
+  float left = sourceRect.x / textureSize_.x;
+  float right = (sourceRect.x + sourceRect.w) / textureSize_.x;
+  float top = sourceRect.y / textureSize_.y;
+  float bottom = (sourceRect.y + sourceRect.h) / textureSize_.y;
+
+  if ((flipMode & SDL_FLIP_HORIZONTAL) != 0) {
+    std::swap(left, right);
+  }
+  if ((flipMode & SDL_FLIP_VERTICAL) != 0) {
+    std::swap(top, bottom);
+  }
+
+  constexpr SDL_FColor white{1, 1, 1, 1};
+  const auto base = static_cast<int>(vertices_.size());
+  const auto destLeft = (destRect.x - view_.origin.x) * view_.scale;
+  const auto destTop = (destRect.y - view_.origin.y) * view_.scale;
+  const auto destRight = destLeft + (destRect.w * view_.scale);
+  const auto destBottom = destTop + (destRect.h * view_.scale);
+
+  vertices_.push_back({{destLeft, destTop}, white, {left, top}});
+  vertices_.push_back({{destRight, destTop}, white, {right, top}});
+  vertices_.push_back({{destRight, destBottom}, white, {right, bottom}});
+  vertices_.push_back({{destLeft, destBottom}, white, {left, bottom}});
+
+  indices_.insert(indices_.end(),
+                  {base, base + 1, base + 2, base + 2, base + 3, base});
+}
+
+auto SpriteBatch::flush() noexcept -> void {
+  if (!vertices_.empty()) {
+    renderer_->renderGeometry(texture_, vertices_, indices_);
+  }
+  vertices_.clear();
+  indices_.clear();
+}
+
 export class SdlWindow {
 public:
   SdlWindow(const char *name, const SDL_Point &size, Uint32 flags)
@@ -196,6 +393,17 @@ public:
     return renderer;
   }
 
+  /// create a renderer drawing on the CPU, without vertical synchronization
+  [[nodiscard]] auto createSoftwareRenderer() const -> SdlRenderer {
+    auto *rendererPtr = SDL_CreateRenderer(window_, SDL_SOFTWARE_RENDERER);
+    if (rendererPtr == nullptr) {
+      throw InitError{std::format("SDL_CreateRenderer(): {}", SDL_GetError())};
+    }
+
+    SdlRenderer renderer{rendererPtr};
+    return renderer;
+  }
+
   [[nodiscard]] auto getWindowID() const noexcept -> SDL_WindowID {
     return SDL_GetWindowID(window_);
   };
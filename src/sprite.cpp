@@ -1,156 +1,157 @@
 module;
 
 #include "SDL3/SDL_rect.h"
+#include "SDL3/SDL_surface.h"
 
 #include <SDL3_image/SDL_image.h>
 
-#include <cmath>
-#include <string>
-#include <utility>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 export module sprite;
-import tile;
+import animation;
 import sdlHelpers;
 
-export class CharacterSprite final : public Renderable {
+/// animation state of a character, the frames shown by its sprite
+export struct SpriteAnimation {
+  /// whether the running frames are shown instead of the idle ones
+  bool running;
+  /// whether the sprite is mirrored to face left
+  bool flip;
+  /// number of rendered frames still showing the hit frame
+  std::uint8_t hitFrames;
+};
+
+/// description of a character or enemy kind, used to render the characters of
+/// this kind
+export class CharacterSprite final {
 public:
-  CharacterSprite(std::string name, const SDL_FRect &rect, bool canRun,
+  /// number of rendered frames showing the hit frame after a hit
+  static constexpr std::uint8_t hitFrameCount{2};
+
+  /// constructor
+  ///
+  /// \param[in] Name the name of the sprite, not copied, it has to outlive
+  /// the sprite and be null terminated, see Catalog::intern()
+  /// \param[in] Rect the source area of the first frame in the texture
+  /// \param[in] CanRun whether the sprite has running frames
+  /// \param[in] CanHit whether the sprite has a hit frame
+  CharacterSprite(std::string_view name, const SDL_FRect &rect, bool canRun,
                   bool canHit);
 
-  CharacterSprite(const CharacterSprite &) = default;
-  CharacterSprite(CharacterSprite &&) = delete;
-  auto operator=(const CharacterSprite &) -> CharacterSprite & = default;
-  auto operator=(CharacterSprite &&) -> CharacterSprite & = delete;
-
-  ~CharacterSprite() override = default;
-
-  [[nodiscard]] auto getIdleTextureRect() const noexcept -> SDL_FRect;
-  [[nodiscard]] auto getRunTextureRect() const noexcept -> SDL_FRect;
+  [[nodiscard]] auto getIdleTextureRect(size_t frame) const noexcept
+      -> SDL_FRect;
+  [[nodiscard]] auto getRunTextureRect(size_t frame) const noexcept
+      -> SDL_FRect;
   [[nodiscard]] auto getHitTextureRect() const noexcept -> SDL_FRect;
-  [[nodiscard]] auto getTextureRect() -> SDL_FRect;
-  [[nodiscard]] auto getDestRect() const noexcept -> SDL_FRect;
-
-  auto serialize(std::ostream &ostream) -> void override {}
 
-  [[nodiscard]] auto name() const noexcept -> std::string override {
+  /// get the source area of the frame shown for an animation state
+  ///
+  /// \param[in] Animation the animation state of the character
+  /// \param[in] Frame the current frame of the animation clock
+  [[nodiscard]] auto getTextureRect(const SpriteAnimation &animation,
+                                    size_t frame) const noexcept -> SDL_FRect;
+
+  /// get the area covered by a character of this kind
+  ///
+  /// \param[in] Pos the position of the feet of the character
+  [[nodiscard]] auto getDestRect(const SDL_FPoint &pos) const noexcept
+      -> SDL_FRect;
+
+  /// get the name of the sprite, null terminated
+  [[nodiscard]] auto name() const noexcept -> std::string_view {
     return renderableName_;
   }
 
-  auto incIndex();
-
-  auto setHit() { hit_ = true; }
-  auto setRunning(bool dir) {
-    this->running_ = true;
-    direction_ = dir;
-  }
-  auto setRunning() { this->running_ = true; }
-  auto setIdle() { this->running_ = false; }
-
-  auto render(const SdlRenderer &renderer, const SdlTexturePtr &texture,
-              size_t frameCount) -> void override;
-
-  [[nodiscard]] auto isSamePos(const SDL_FPoint &pos) const -> bool override {
-    return renderablePos_.x == pos.x && renderablePos_.y == pos.y;
-  }
-
-  auto setPos(const SDL_FPoint &pos) noexcept -> void { renderablePos_ = pos; };
-  [[nodiscard]] auto getPos() const noexcept -> SDL_FPoint override {
-    return {renderablePos_.x,
-            renderablePos_.y + (renderableLevel_ ? sourceRect_.h : 0)};
-  }
+  /// render a character of this kind
+  ///
+  /// \param[in] Batch the sprite batch to add the character to
+  /// \param[in] Texture the texture containing the sprite
+  /// \param[in] Pos the position of the feet of the character
+  /// \param[in] Animation the animation state of the character
+  /// \param[in] Clock the clock giving the current animation frames
+  auto render(SpriteBatch &batch, const SdlTexturePtr &texture,
+              const SDL_FPoint &pos, const SpriteAnimation &animation,
+              const AnimationClock &clock) const -> void;
 
 private:
   static constexpr float runFrameIndex = 4;
   static constexpr float hitFrameIndex = 8;
-  static constexpr float animationFrameNumber = 4;
+  static constexpr size_t animationFrameNumber = 4;
+
+  /// get the source area of a frame of the sprite sheet
+  [[nodiscard]] auto frameRect(float frameIndex) const noexcept -> SDL_FRect;
 
-  float index_{};
-  bool hit_{};
-  bool running_{};
-  bool direction_{};
   bool canRun_;
   bool canHit_;
-  int hitFrame_ = 0;
 
-  std::string renderableName_;
+  /// the name of the sprite, interned
+  std::string_view renderableName_;
   /// the Renderable rectangle area in the texture
   SDL_FRect sourceRect_{};
-  /// whether the Renderable is animated
-  bool renderableIsAnimated_{};
-  /// The renderable position on the screen
-  SDL_FPoint renderablePos_{};
-  /// whether the Renderable is on the ground or in the air
-  bool renderableLevel_{};
+
+  /// the source area of each idle and running animation frame
+  std::array<SDL_FRect, animationFrameNumber> idleRects_{};
+  std::array<SDL_FRect, animationFrameNumber> runRects_{};
 };
 
-CharacterSprite::CharacterSprite(std::string name, const SDL_FRect &rect,
+CharacterSprite::CharacterSprite(std::string_view name, const SDL_FRect &rect,
                                  bool canRun, bool canHit)
-    : renderableName_{std::move(name)}, sourceRect_{rect},
-      canRun_{canRun}, canHit_{canHit} {}
+    : canRun_{canRun}, canHit_{canHit}, renderableName_{name},
+      sourceRect_{rect} {
+  for (size_t frame = 0; frame < animationFrameNumber; ++frame) {
+    idleRects_[frame] = frameRect(static_cast<float>(frame));
+    runRects_[frame] = frameRect(runFrameIndex + static_cast<float>(frame));
+  }
+}
 
-auto CharacterSprite::getIdleTextureRect() const noexcept -> SDL_FRect {
+auto CharacterSprite::frameRect(float frameIndex) const noexcept -> SDL_FRect {
+  return {sourceRect_.x + (frameIndex * sourceRect_.w), sourceRect_.y,
+          sourceRect_.w, sourceRect_.h};
+}
 
-  return {sourceRect_.x + (index_ * sourceRect_.w),
-          sourceRect_.y, sourceRect_.w,
-          sourceRect_.h};
+auto CharacterSprite::getIdleTextureRect(size_t frame) const noexcept
+    -> SDL_FRect {
+  return idleRects_[frame];
 }
 
-auto CharacterSprite::getRunTextureRect() const noexcept -> SDL_FRect {
-  return {sourceRect_.x +
-              ((runFrameIndex + index_) * sourceRect_.w),
-          sourceRect_.y, sourceRect_.w,
-          sourceRect_.h};
+auto CharacterSprite::getRunTextureRect(size_t frame) const noexcept
+    -> SDL_FRect {
+  return runRects_[frame];
 }
 
 auto CharacterSprite::getHitTextureRect() const noexcept -> SDL_FRect {
-  return {sourceRect_.x + (hitFrameIndex * sourceRect_.w),
-          sourceRect_.y, sourceRect_.w,
-          sourceRect_.h};
+  return frameRect(hitFrameIndex);
 }
 
-auto CharacterSprite::getTextureRect() -> SDL_FRect {
-  if (canHit_ && hit_) {
-    if (++hitFrame_ == 2) {
-      hitFrame_ = 0;
-      hit_ = false;
-    }
+auto CharacterSprite::getTextureRect(const SpriteAnimation &animation,
+                                     size_t frame) const noexcept
+    -> SDL_FRect {
+  if (canHit_ && animation.hitFrames > 0) {
     return getHitTextureRect();
   }
 
-  if (canRun_ && running_) {
-    return getRunTextureRect();
+  if (canRun_ && animation.running) {
+    return getRunTextureRect(frame);
   }
 
-  return getIdleTextureRect();
+  return getIdleTextureRect(frame);
 }
 
-auto CharacterSprite::getDestRect() const noexcept -> SDL_FRect {
-  const SDL_FRect pos{.x = renderablePos_.x * 2,
-                      .y = (renderablePos_.y - sourceRect_.h) * 2};
-
-  return {pos.x, pos.y, sourceRect_.w * 2,
+auto CharacterSprite::getDestRect(const SDL_FPoint &pos) const noexcept
+    -> SDL_FRect {
+  return {pos.x * 2, (pos.y - sourceRect_.h) * 2, sourceRect_.w * 2,
           sourceRect_.h * 2};
 }
 
-auto CharacterSprite::incIndex() {
-  index_ = std::fmod(++index_, animationFrameNumber);
-}
-
-auto CharacterSprite::render(const SdlRenderer &renderer,
-                             const SdlTexturePtr &texture, size_t frameCount)
-    -> void {
-  if (frameCount % 2 == 0) {
-    incIndex();
-  }
-
-  const auto destRect = getDestRect();
-  const auto sourceTextureRect = getTextureRect();
-
-  if (direction_) {
-    const SDL_FPoint center{0, 0};
-    renderer.renderTextureRotated(texture, sourceTextureRect, destRect, 0,
-                                  center, SDL_FLIP_HORIZONTAL);
-  } else {
-    renderer.renderTexture(texture, sourceTextureRect, destRect);
-  }
+auto CharacterSprite::render(SpriteBatch &batch, const SdlTexturePtr &texture,
+                             const SDL_FPoint &pos,
+                             const SpriteAnimation &animation,
+                             const AnimationClock &clock) const -> void {
+  batch.addQuad(texture,
+                getTextureRect(animation, clock.frame(animationFrameNumber)),
+                getDestRect(pos),
+                animation.flip ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
 }
@@ -3,114 +3,18 @@ module;
 #include "SDL3/SDL_rect.h"
 #include "SDL3/SDL_render.h"
 
-#include <cmath>
-#include <memory>
+#include <array>
+#include <cstddef>
+#include <istream>
+#include <ostream>
 #include <string>
-#include <utility>
+#include <string_view>
 
 export module tile;
+import animation;
+import grid;
 import sdlHelpers;
 
-/// renderer concept
-export template <class Type>
-concept isRenderer =
-    requires(Type type, const SdlRenderer &renderer,
-             const SdlTexturePtr &texture, const SDL_FRect &rect,
-             const SDL_FPoint &pos, size_t frameCount) {
-      { type.render(renderer, texture, rect, pos, frameCount) };
-    };
-
-/// renderer for static sprite
-export class StaticRenderer {
-public:
-  /// render the static sprite to the screen
-  ///
-  /// \param[in] Renderer the renderer to use to render the static sprite to the
-  /// screen
-  /// \param[in] Texture the texture to get the sprite from
-  /// \param[in] SourceRect the source area for the static sprites
-  /// \param[in] Pos the position on the screen where to render the static
-  /// sprite
-  /// \param[in] FrameCount the number of frame already rendered
-  static auto render(const SdlRenderer &renderer, const SdlTexturePtr &texture,
-                     const SDL_FRect &rect, const SDL_FPoint &pos,
-                     size_t frameCount) -> void;
-};
-
-auto StaticRenderer::render(const SdlRenderer &renderer,
-                            const SdlTexturePtr &texture, const SDL_FRect &rect,
-                            const SDL_FPoint &pos, size_t /*FrameCount*/)
-    -> void {
-
-  const SDL_FRect destRect{pos.x * 2, (pos.y - rect.h) * 2, rect.w * 2,
-                           rect.h * 2};
-
-  renderer.renderTexture(texture, rect, destRect);
-}
-
-namespace {
-auto operator<<(std::ostream &ostream, const StaticRenderer & /*unused*/)
-    -> std::ostream & {
-  ostream << "static";
-  return ostream;
-}
-} // namespace
-
-/// renderer for animated sprite
-export class AnimatedRenderer {
-public:
-  /// render the animation sprite to the screen
-  ///
-  /// \param[in] Renderer the renderer to use to render the animation sprite to
-  /// the screen
-  /// \param[in] Texture the texture to get the sprite from
-  /// \param[in] SourceRect the source area for the animation sprites
-  /// \param[in] Pos the position on the screen where to render the animation
-  /// sprite
-  /// \param[in] FrameCount the number of frame already rendered
-  auto render(const SdlRenderer &renderer, const SdlTexturePtr &texture,
-              const SDL_FRect &sourceRect, const SDL_FPoint &pos,
-              size_t frameCount) -> void;
-
-private:
-  static constexpr float frameNumber = 3;
-
-  float index_;      ///< the index in the animation fram list
-  size_t lastFrame_; ///< the last frame count rendered
-};
-
-namespace {
-/// output 'animated' to an output stream
-///
-/// \param[in] Os the output stream
-///
-/// \return the output stream
-auto operator<<(std::ostream &ostream, const AnimatedRenderer & /*unused*/)
-    -> std::ostream & {
-  ostream << "animated";
-  return ostream;
-}
-} // namespace
-
-auto AnimatedRenderer::render(const SdlRenderer &renderer,
-                              const SdlTexturePtr &texture,
-                              const SDL_FRect &rect, const SDL_FPoint &pos,
-                              size_t frameCount) -> void {
-
-  if (lastFrame_ != frameCount && frameCount % 2 == 0) {
-    lastFrame_ = frameCount;
-    index_ = std::fmod(++index_, frameNumber);
-  }
-
-  const SDL_FRect destRect{pos.x * 2, (pos.y - rect.h) * 2, rect.w * 2,
-                           rect.h * 2};
-
-  const SDL_FRect sourceRect{(index_ * rect.w) + rect.x, rect.y, rect.w,
-                             rect.h};
-
-  renderer.renderTexture(texture, sourceRect, destRect);
-}
-
 export class Renderable {
 public:
   Renderable() = default;
@@ -121,18 +25,18 @@ public:
   virtual ~Renderable() = default;
 
   /// return the name the renderable
-  [[nodiscard]] virtual auto name() const noexcept -> std::string = 0;
+  [[nodiscard]] virtual auto name() const noexcept -> std::string_view = 0;
 
   /// check if the renderable is in pos
   [[nodiscard]] virtual auto isSamePos(const SDL_FPoint &pos) const -> bool = 0;
 
   /// render the Renderable to the screen
   ///
-  /// \param[in] Renderer the renderer used to render the renderable
+  /// \param[in] Batch the sprite batch to add the renderable to
   /// \param[in] Texture the texture containing the Renderable sprite
-  /// \param[in] FrameCount the number of frame already drawn to the screen
-  virtual auto render(const SdlRenderer &renderer, const SdlTexturePtr &texture,
-                      size_t frameCount) -> void = 0;
+  /// \param[in] Clock the clock giving the current animation frames
+  virtual auto render(SpriteBatch &batch, const SdlTexturePtr &texture,
+                      const AnimationClock &clock) -> void = 0;
 
   /// serialize the Renderable to an ostream
   virtual auto serialize(std::ostream &) -> void = 0;
@@ -146,181 +50,154 @@ export auto operator<<(std::ostream &ostream, Renderable &renderable)
   return ostream;
 }
 
-export class TileConcrete : public Renderable {};
+/// renderable tile
+export class TileConcrete : public Renderable {
+public:
+  /// check if the tile sprite changes over time
+  [[nodiscard]] virtual auto isAnimated() const noexcept -> bool = 0;
 
-/// concrete renderable class for tiles
-///
-/// \tparam RendererType the renderer type to use
-export template <class RendererType>
-  requires isRenderer<RendererType>
-class Tile : public TileConcrete {
-  friend auto operator<<(std::ostream &ostream, const Tile<RendererType> &tile)
-      -> std::ostream &;
-  friend auto operator>>(std::istream &istream, Tile<RendererType> &tile)
-      -> std::istream &;
+  /// get the tile position without the level offset used for sorting
+  [[nodiscard]] virtual auto getRenderablePos() const noexcept
+      -> SDL_FPoint = 0;
+};
 
+/// description of a tile kind, used to render and serialize the tiles of this
+/// kind
+export class RendererBuilder {
 public:
   /// default constructor
-  Tile() = default;
+  RendererBuilder() = default;
 
   /// constructor
   ///
-  /// \param[in] Name the name of the Renderable
-  /// \param[in] Rect the Renderable source area in the texture
-  Tile(std::string name, const SDL_FRect &rect, const SDL_FPoint &pos,
-       bool level);
-
-  [[nodiscard]] auto name() const noexcept -> std::string override {
-    return name_;
-  }
-
-  [[nodiscard]] auto getPos() const noexcept -> SDL_FPoint override {
-    return {renderablePos_.x,
-            renderablePos_.y + (renderableLevel_ ? sourceRect_.h : 0)};
+  /// \param[in] Name the name of the Renderable, not copied, it has to outlive
+  /// the builder and be null terminated, see Catalog::intern()
+  /// \param[in] Animated whether the Renterable is animated
+  /// \param[in] SourceRect the source area for the renderable in the texture
+  RendererBuilder(std::string_view name, bool animated,
+                  const SDL_FRect &sourceRect)
+      : renderableName_{name}, renderableSourceRect_{sourceRect},
+        renderableIsAnimated_{animated} {
+    updateFrames();
   }
 
-  /// render the renderable to the screen
+  /// render a tile of this kind
   ///
-  /// \param[in] Renderer the renderer used to render to the screen
-  /// \param[in] Texture the texture to get the renderable sprite from
-  /// \param[in] FrameCount the number of frame already drawn
-  auto render(const SdlRenderer &renderer, const SdlTexturePtr &texture,
-              size_t frameCount) -> void override;
-
-  /// serialize the Renderable to an output stream
+  /// \param[in] Batch the sprite batch to add the tile to
+  /// \param[in] Texture the texture to get the tile sprite from
+  /// \param[in] Pos the tile position
+  /// \param[in] Clock the clock giving the current animation frame
+  auto render(SpriteBatch &batch, const SdlTexturePtr &texture,
+              const SDL_FPoint &pos, const AnimationClock &clock) const
+      -> void;
+
+  /// serialize a tile of this kind to an output stream
   ///
-  /// the renderable is write to the output stream in the form:\n
+  /// the tile is write to the output stream in the form:\n
   /// RenderableName RendererType RenderableSourceRect RenderablePos
   /// RenderableLevel
-  auto serialize(std::ostream &ostream) -> void override {
-    ostream << name_ << ' ' << tileRenderer_ << ' ' << sourceRect_ << ' '
-            << renderablePos_ << ' ' << renderableLevel_;
+  auto serialize(std::ostream &ostream, const SDL_FPoint &pos,
+                 bool level) const -> void;
+
+  /// get the name of the Renderable, null terminated
+  [[nodiscard]] auto name() const noexcept -> std::string_view {
+    return renderableName_;
   }
 
-  auto setLevel(bool level) -> void { renderableLevel_ = level; }
-  [[nodiscard]] auto getLevel() const -> bool { return renderableLevel_; }
+  /// check if the Renderable is animated
+  [[nodiscard]] auto isAnimated() const noexcept -> bool {
+    return renderableIsAnimated_;
+  }
 
-  auto setPos(const SDL_FPoint &pos) -> void { renderablePos_ = pos; }
+  /// get the Renderable rectangle area in the texture
+  [[nodiscard]] auto getSourceRect() const noexcept -> const SDL_FRect & {
+    return renderableSourceRect_;
+  }
 
-  [[nodiscard]] auto isSamePos(const SDL_FPoint &pos) const -> bool override {
-    return renderablePos_.x == pos.x && renderablePos_.y == pos.y;
+  /// check if the floor tiles of this kind can be baked into their chunk,
+  /// the static ones fitting in their cell. The others overflow the cell and
+  /// could be cut at the chunk border
+  [[nodiscard]] auto isBakeable() const noexcept -> bool {
+    return !renderableIsAnimated_ && renderableSourceRect_.w <= gridSize &&
+           renderableSourceRect_.h <= gridSize;
   }
 
 private:
-  std::string name_;
-  RendererType tileRenderer_;
-  /// whether the Renderable is on the ground or in the air
-  bool renderableLevel_{};
-
-  /// the Renderable Pos on the screen
-  SDL_FPoint renderablePos_{};
-  /// the Renderable source rectangle on the texture
-  SDL_FRect sourceRect_{};
-};
+  /// number of frames of the animated tiles animation
+  static constexpr size_t animationFrameNumber{3};
 
-template <class R>
-  requires isRenderer<R>
-Tile<R>::Tile(std::string name, const SDL_FRect &rect, const SDL_FPoint &pos,
-              bool level)
-    : name_{std::move(name)}, renderableLevel_{level}, renderablePos_{pos},
-      sourceRect_{rect} {}
-
-template <class RendererType>
-  requires isRenderer<RendererType>
-auto Tile<RendererType>::render(const SdlRenderer &renderer,
-                                const SdlTexturePtr &texture, size_t frameCount)
-    -> void {
-  tileRenderer_.render(renderer, texture, sourceRect_, renderablePos_,
-                       frameCount);
-}
+  /// compute the source area of each animation frame
+  auto updateFrames() noexcept -> void;
 
-/// Factory used to create Renderable
-export class RendererBuilder {
-  friend auto operator>>(std::istream &istream, RendererBuilder &builder)
-      -> std::istream &;
-
-public:
-  /// default constructor
-  RendererBuilder() = default;
-
-  /// constructor
-  ///
-  /// \param[in] Name the name of the Renderable
-  /// \param[in] Animated whether the Renterable is animated
-  /// \param[in] SourceRect the source area for the renderable in the texture
-  RendererBuilder(std::string_view name, bool animated,
-                  const SDL_FRect &sourceRect)
-      : renderableName_{name}, renderableSourceRect_{sourceRect},
-        renderableIsAnimated_{animated} {}
-
-  /// create the Renterable
-  auto build(const SDL_FPoint &pos, bool level)
-      -> std::unique_ptr<TileConcrete>;
-  auto build() -> std::unique_ptr<TileConcrete>;
-
-  /// get the name of the Renderable
-  auto name() -> const std::string & { return renderableName_; }
-
-private:
-  /// the name of the Renderable
-  std::string renderableName_;
+  /// the name of the Renderable, interned
+  std::string_view renderableName_;
   /// the Renderable rectangle area in the texture
   SDL_FRect renderableSourceRect_{};
   /// whether the Renderable is animated
   bool renderableIsAnimated_{};
-  /// The renderable position on the screen
-  SDL_FPoint renderablePos_{};
-  /// whether the Renderable is on the ground or in the air
-  bool renderableLevel_{};
+  /// the source area of each animation frame
+  std::array<SDL_FRect, animationFrameNumber> frames_{};
+  /// the number of used entries in frames_
+  size_t frameNumber_{1};
 };
 
-auto RendererBuilder::build(const SDL_FPoint &pos, bool level)
-    -> std::unique_ptr<TileConcrete> {
-
-  std::unique_ptr<TileConcrete> renderable;
-  if (renderableIsAnimated_) {
-    renderable = std::make_unique<Tile<AnimatedRenderer>>(
-        renderableName_, renderableSourceRect_, pos, level);
-  } else {
-    renderable = std::make_unique<Tile<StaticRenderer>>(
-        renderableName_, renderableSourceRect_, pos, level);
+auto RendererBuilder::updateFrames() noexcept -> void {
+  frameNumber_ = renderableIsAnimated_ ? animationFrameNumber : 1;
+  for (size_t index = 0; index < frameNumber_; ++index) {
+    frames_[index] = {renderableSourceRect_.x +
+                          (static_cast<float>(index) * renderableSourceRect_.w),
+                      renderableSourceRect_.y, renderableSourceRect_.w,
+                      renderableSourceRect_.h};
   }
+}
 
-  return renderable;
+auto RendererBuilder::render(SpriteBatch &batch, const SdlTexturePtr &texture,
+                             const SDL_FPoint &pos,
+                             const AnimationClock &clock) const -> void {
+  const auto &sourceRect = frames_[clock.frame(frameNumber_)];
+  const SDL_FRect destRect{pos.x * 2, (pos.y - sourceRect.h) * 2,
+                           sourceRect.w * 2, sourceRect.h * 2};
+
+  batch.addQuad(texture, sourceRect, destRect);
 }
-auto RendererBuilder::build() -> std::unique_ptr<TileConcrete> {
-
-  std::unique_ptr<TileConcrete> renderable;
-  if (renderableIsAnimated_) {
-    renderable = std::make_unique<Tile<AnimatedRenderer>>(
-        renderableName_, renderableSourceRect_, renderablePos_,
-        renderableLevel_);
-  } else {
-    renderable = std::make_unique<Tile<StaticRenderer>>(
-        renderableName_, renderableSourceRect_, renderablePos_,
-        renderableLevel_);
-  }
 
-  return renderable;
+auto RendererBuilder::serialize(std::ostream &ostream, const SDL_FPoint &pos,
+                                bool level) const -> void {
+  ostream << renderableName_ << ' '
+          << (renderableIsAnimated_ ? "animated" : "static") << ' '
+          << renderableSourceRect_ << ' ' << pos << ' ' << level;
 }
 
-/// read Builder from an input stream
-/// the Builder information to read has to be in the form :\n
+/// a tile of a text level, as written by RendererBuilder::serialize()
+export struct TileRecord {
+  /// the name of the tile kind
+  std::string name;
+  /// whether the tile kind is animated
+  bool animated{};
+  /// the tile kind rectangle area in the texture
+  SDL_FRect sourceRect{};
+  /// the tile position
+  SDL_FPoint pos{};
+  /// whether the tile is on the ground or in the air
+  bool level{};
+};
+
+/// read a tile record from an input stream
+/// the record information to read has to be in the form :\n
 /// 'RenderableName RenderableType RenderableRourceRect RenderablePos
 /// RenderableLevel'\n with:\n RenderableType = (Static|Animated) \n
 /// RenderableSourceRect = x y w h\n
 /// RenderablePos = x y
 ///
-/// \param &Builer the Builder to put the information to
-export auto operator>>(std::istream &istream, RendererBuilder &builder)
+/// \param &Record the record to put the information to
+export auto operator>>(std::istream &istream, TileRecord &record)
     -> std::istream & {
 
   auto streamPos = istream.tellg();
   std::string animated;
 
-  istream >> builder.renderableName_ >> animated >>
-      builder.renderableSourceRect_ >> builder.renderablePos_ >>
-      builder.renderableLevel_;
+  istream >> record.name >> animated >> record.sourceRect >> record.pos >>
+      record.level;
 
   if (!istream) {
     istream.clear();
@@ -329,7 +206,7 @@ export auto operator>>(std::istream &istream, RendererBuilder &builder)
     return istream;
   }
 
-  builder.renderableIsAnimated_ = (animated == "animated");
+  record.animated = (animated == "animated");
 
   return istream;
 }
@@ -0,0 +1,434 @@
+module;
+
+#include "SDL3/SDL_rect.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+export module tileStore;
+
+import animation;
+import grid;
+import sdlHelpers;
+import tile;
+
+/// index of a tile in a TileStore, stable until the tile is erased
+export using TileSlot = std::uint32_t;
+
+/// index of a tile kind in the tile catalog
+export using CatalogId = std::uint16_t;
+
+/// the cells a TileStore holds, whose coordinates fit in 16 bits
+///
+/// the lowest 16 bit coordinate is left out, the packed cell with both
+/// coordinates at that value marks the empty buckets of the cell index
+export constexpr CellArea storableCells{
+    .first = {.x = -std::numeric_limits<std::int16_t>::max(),
+              .y = -std::numeric_limits<std::int16_t>::max()},
+    .last = {.x = std::numeric_limits<std::int16_t>::max(),
+             .y = std::numeric_limits<std::int16_t>::max()}};
+
+/// pack a cell in 32 bits, x in the low half and y in the high half
+///
+/// the coordinates are truncated to 16 bits, only the storableCells are
+/// packed without loss
+export constexpr auto packCell(const Cell &cell) noexcept -> std::uint32_t {
+  return static_cast<std::uint16_t>(cell.x) |
+         (static_cast<std::uint32_t>(static_cast<std::uint16_t>(cell.y))
+          << 16U);
+}
+
+/// unpack a cell packed by packCell()
+export constexpr auto unpackCell(std::uint32_t packed) noexcept -> Cell {
+  return {.x = static_cast<std::int16_t>(packed & 0xFFFFU),
+          .y = static_cast<std::int16_t>(packed >> 16U)};
+}
+
+/// map from packed cells to tile slots, stored in an open addressing hash
+/// table with linear probing
+///
+/// lookups, insertions and removals cost the same whatever the number of
+/// cells, the table doubles when half full
+class CellIndex {
+public:
+  /// packed cell of an empty bucket, never a key
+  static constexpr std::uint32_t emptyKey{
+      packCell({.x = std::numeric_limits<std::int16_t>::min(),
+                .y = std::numeric_limits<std::int16_t>::min()})};
+
+  /// find the slot of a cell
+  [[nodiscard]] auto find(std::uint32_t key) const noexcept
+      -> std::optional<TileSlot> {
+    if (keys_.empty()) {
+      return std::nullopt;
+    }
+    for (auto bucket = home(key);; bucket = next(bucket)) {
+      if (keys_[bucket] == key) {
+        return slots_[bucket];
+      }
+      if (keys_[bucket] == emptyKey) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  /// map a cell to a slot, replacing its previous slot
+  ///
+  /// \return the replaced slot, if the cell was mapped
+  auto insert(std::uint32_t key, TileSlot slot) -> std::optional<TileSlot>;
+
+  /// remove a cell
+  auto erase(std::uint32_t key) noexcept -> void;
+
+  auto clear() noexcept -> void {
+    std::ranges::fill(keys_, emptyKey);
+    size_ = 0;
+  }
+
+  /// grow the table to hold a number of cells without rehashing
+  auto reserve(size_t count) -> void {
+    if (count * 2 > keys_.size()) {
+      rehash(std::bit_ceil(count * 2));
+    }
+  }
+
+private:
+  /// smallest number of buckets of a table
+  static constexpr size_t minBuckets{16};
+
+  [[nodiscard]] auto home(std::uint32_t key) const noexcept -> size_t {
+    // Fibonacci hashing spreads the neighbouring cells over the table
+    constexpr std::uint64_t multiplier{0x9E3779B97F4A7C15};
+    return static_cast<size_t>((key * multiplier) >> 32U) & mask_;
+  }
+  [[nodiscard]] auto next(size_t bucket) const noexcept -> size_t {
+    return (bucket + 1) & mask_;
+  }
+
+  /// move every cell to a table of a number of buckets, a power of two
+  auto rehash(size_t bucketCount) -> void;
+
+  std::vector<std::uint32_t> keys_;
+  std::vector<TileSlot> slots_;
+  size_t mask_{};
+  size_t size_{};
+};
+
+auto CellIndex::insert(std::uint32_t key, TileSlot slot)
+    -> std::optional<TileSlot> {
+  if ((size_ + 1) * 2 > keys_.size()) {
+    rehash(std::max(minBuckets, keys_.size() * 2));
+  }
+  auto bucket = home(key);
+  while (keys_[bucket] != emptyKey && keys_[bucket] != key) {
+    bucket = next(bucket);
+  }
+  if (keys_[bucket] == emptyKey) {
+    keys_[bucket] = key;
+    slots_[bucket] = slot;
+    ++size_;
+    return std::nullopt;
+  }
+  return std::exchange(slots_[bucket], slot);
+}
+
+auto CellIndex::erase(std::uint32_t key) noexcept -> void {
+  if (keys_.empty()) {
+    return;
+  }
+  auto bucket = home(key);
+  while (keys_[bucket] != key) {
+    if (keys_[bucket] == emptyKey) {
+      return;
+    }
+    bucket = next(bucket);
+  }
+  --size_;
+
+  // shift back the following cells of the run so the lookups do not stop at
+  // the emptied bucket
+  auto hole = bucket;
+  for (auto candidate = next(hole); keys_[candidate] != emptyKey;
+       candidate = next(candidate)) {
+    const auto candidateHome = home(keys_[candidate]);
+    // the candidate can fill the hole if its home is not between the hole
+    // and itself, cyclically
+    if (((candidate - candidateHome) & mask_) >=
+        ((candidate - hole) & mask_)) {
+      keys_[hole] = keys_[candidate];
+      slots_[hole] = slots_[candidate];
+      hole = candidate;
+    }
+  }
+  keys_[hole] = emptyKey;
+}
+
+auto CellIndex::rehash(size_t bucketCount) -> void {
+  auto keys = std::exchange(keys_, std::vector(bucketCount, emptyKey));
+  auto slots = std::exchange(slots_, std::vector<TileSlot>(bucketCount));
+  mask_ = bucketCount - 1;
+  size_ = 0;
+  for (size_t bucket = 0; bucket < keys.size(); ++bucket) {
+    if (keys[bucket] != emptyKey) {
+      insert(keys[bucket], slots[bucket]);
+    }
+  }
+}
+
+/// tiles of a map layer stored as parallel arrays
+///
+/// erased slots are recycled by the following insertions so the slots of the
+/// other tiles never move. A cell holds at most one tile, found in constant
+/// time through a cell index
+export class TileStore {
+public:
+  /// catalog id of an unused slot
+  static constexpr CatalogId freeId{std::numeric_limits<CatalogId>::max()};
+
+  /// a tile given to assign()
+  struct PackedTile {
+    /// the cell packed by packCell(), one of the storableCells
+    std::uint32_t cell;
+    /// the kind of the tile, freeId to skip the tile
+    CatalogId catalogId;
+    bool level;
+  };
+
+  /// add a tile, replacing the tile of its cell
+  ///
+  /// \param[in] Cell the cell of the tile
+  /// \param[in] CatalogId the kind of the tile
+  /// \param[in] Level whether the tile is on the ground or in the air
+  ///
+  /// \return the slot of the new tile, the slot of the replaced tile if the
+  /// cell was used
+  /// \throw std::out_of_range if the cell is not in the storableCells
+  auto insert(const Cell &cell, CatalogId catalogId, bool level) -> TileSlot;
+
+  /// remove a tile
+  auto erase(TileSlot slot) noexcept -> void;
+
+  /// find the tile in a cell, never found outside the storableCells
+  [[nodiscard]] auto find(const Cell &cell) const noexcept
+      -> std::optional<TileSlot>;
+
+  /// remove every tile
+  auto clear() noexcept -> void;
+
+  /// reserve memory for a number of tiles
+  auto reserve(size_t count) -> void;
+
+  /// replace every tile with the tiles of a range
+  ///
+  /// the arrays are sized once and filled in the order of the range, each
+  /// tile costs one probe of the cell index and no check, unlike insert().
+  /// A cell given twice keeps its last tile
+  ///
+  /// \param[in] Tiles the tiles, their cells must be storableCells
+  /// \param[in] Pack converts a tile of the range to a PackedTile
+  template <std::ranges::sized_range Tiles, class Pack>
+  auto assign(const Tiles &tiles, Pack pack) -> void {
+    clear();
+    reserve(std::ranges::size(tiles));
+    for (const auto &tile : tiles) {
+      const PackedTile packed = pack(tile);
+      if (packed.catalogId == freeId) {
+        continue;
+      }
+      const auto slot = static_cast<TileSlot>(catalogIds_.size());
+      catalogIds_.push_back(packed.catalogId);
+      cells_.push_back(packed.cell);
+      levels_.push_back(packed.level ? 1 : 0);
+      if (const auto replaced = cellIndex_.insert(packed.cell, slot)) {
+        catalogIds_[*replaced] = freeId;
+        cells_[*replaced] = freeCell;
+        freeSlots_.push_back(*replaced);
+      } else {
+        ++size_;
+      }
+    }
+  }
+
+  /// get the number of tiles
+  [[nodiscard]] auto size() const noexcept -> size_t { return size_; }
+
+  /// get the number of slots, used or not
+  [[nodiscard]] auto slotCount() const noexcept -> size_t {
+    return catalogIds_.size();
+  }
+
+  [[nodiscard]] auto isUsed(TileSlot slot) const noexcept -> bool {
+    return catalogIds_[slot] != freeId;
+  }
+  [[nodiscard]] auto catalogId(TileSlot slot) const noexcept -> CatalogId {
+    return catalogIds_[slot];
+  }
+  [[nodiscard]] auto cell(TileSlot slot) const noexcept -> Cell {
+    return unpackCell(cells_[slot]);
+  }
+  [[nodiscard]] auto position(TileSlot slot) const noexcept -> SDL_FPoint {
+    return tilePosOf(cell(slot));
+  }
+  [[nodiscard]] auto level(TileSlot slot) const noexcept -> bool {
+    return levels_[slot] != 0;
+  }
+
+  /// call a visitor with the slot of every tile
+  template <class Visitor> auto forEach(Visitor &&visitor) const -> void {
+    for (TileSlot slot = 0; slot < catalogIds_.size(); ++slot) {
+      if (isUsed(slot)) {
+        visitor(slot);
+      }
+    }
+  }
+
+private:
+  /// packed cell of an unused slot, never matched by find()
+  static constexpr std::uint32_t freeCell{CellIndex::emptyKey};
+
+  std::vector<CatalogId> catalogIds_;
+  std::vector<std::uint32_t> cells_;
+  std::vector<std::uint8_t> levels_;
+
+  /// the erased slots, reused first by insert()
+  std::vector<TileSlot> freeSlots_;
+  size_t size_{};
+
+  /// the slot of the tile of each used cell
+  CellIndex cellIndex_;
+};
+
+auto TileStore::insert(const Cell &cell, CatalogId catalogId, bool level)
+    -> TileSlot {
+  if (!storableCells.contains(cell)) {
+    throw std::out_of_range{std::format(
+        "the cell {} {} is outside the storable cells", cell.x, cell.y)};
+  }
+  const auto packed = packCell(cell);
+  if (const auto slot = cellIndex_.find(packed)) {
+    catalogIds_[*slot] = catalogId;
+    levels_[*slot] = level ? 1 : 0;
+    return *slot;
+  }
+
+  ++size_;
+  TileSlot slot{};
+  if (!freeSlots_.empty()) {
+    slot = freeSlots_.back();
+    freeSlots_.pop_back();
+    catalogIds_[slot] = catalogId;
+    cells_[slot] = packed;
+    levels_[slot] = level ? 1 : 0;
+  } else {
+    slot = static_cast<TileSlot>(catalogIds_.size());
+    catalogIds_.push_back(catalogId);
+    cells_.push_back(packed);
+    levels_.push_back(level ? 1 : 0);
+  }
+  cellIndex_.insert(packed, slot);
+  return slot;
+}
+
+auto TileStore::erase(TileSlot slot) noexcept -> void {
+  if (!isUsed(slot)) {
+    return;
+  }
+  --size_;
+  cellIndex_.erase(cells_[slot]);
+  catalogIds_[slot] = freeId;
+  cells_[slot] = freeCell;
+  freeSlots_.push_back(slot);
+}
+
+auto TileStore::find(const Cell &cell) const noexcept
+    -> std::optional<TileSlot> {
+  if (!storableCells.contains(cell)) {
+    return std::nullopt;
+  }
+  return cellIndex_.find(packCell(cell));
+}
+
+auto TileStore::clear() noexcept -> void {
+  catalogIds_.clear();
+  cells_.clear();
+  levels_.clear();
+  freeSlots_.clear();
+  size_ = 0;
+  cellIndex_.clear();
+}
+
+auto TileStore::reserve(size_t count) -> void {
+  catalogIds_.reserve(count);
+  cells_.reserve(count);
+  levels_.reserve(count);
+  cellIndex_.reserve(count);
+}
+
+/// Renderable adapter over a tile of a TileStore
+///
+/// the adapter only references the store, it has to be used before the tile
+/// is erased
+export class StoredTile final : public TileConcrete {
+public:
+  /// constructor
+  ///
+  /// \param[in] Store the store containing the tile
+  /// \param[in] Catalog the tile kinds indexed by catalog id
+  /// \param[in] Slot the slot of the tile in the store
+  StoredTile(const TileStore &store, std::span<const RendererBuilder> catalog,
+             TileSlot slot) noexcept
+      : store_{&store}, catalog_{catalog}, slot_{slot} {}
+
+  [[nodiscard]] auto name() const noexcept -> std::string_view override {
+    return kind().name();
+  }
+
+  [[nodiscard]] auto isSamePos(const SDL_FPoint &pos) const -> bool override {
+    const auto tilePos = getRenderablePos();
+    return tilePos.x == pos.x && tilePos.y == pos.y;
+  }
+
+  auto render(SpriteBatch &batch, const SdlTexturePtr &texture,
+              const AnimationClock &clock) -> void override {
+    kind().render(batch, texture, getRenderablePos(), clock);
+  }
+
+  auto serialize(std::ostream &ostream) -> void override {
+    kind().serialize(ostream, getRenderablePos(), store_->level(slot_));
+  }
+
+  [[nodiscard]] auto getPos() const noexcept -> SDL_FPoint override {
+    const auto pos = getRenderablePos();
+    return {pos.x,
+            pos.y + (store_->level(slot_) ? kind().getSourceRect().h : 0)};
+  }
+
+  [[nodiscard]] auto isAnimated() const noexcept -> bool override {
+    return kind().isAnimated();
+  }
+
+  [[nodiscard]] auto getRenderablePos() const noexcept -> SDL_FPoint override {
+    return store_->position(slot_);
+  }
+
+private:
+  [[nodiscard]] auto kind() const noexcept -> const RendererBuilder & {
+    return catalog_[store_->catalogId(slot_)];
+  }
+
+  const TileStore *store_;
+  std::span<const RendererBuilder> catalog_;
+  TileSlot slot_;
+};
@@ -0,0 +1,27 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_rect.h>
+
+#include <cstddef>
+
+import actorStore;
+
+TEST_CASE("an actor store keeps the actors in insertion order") {
+  ActorStore store;
+  store.reserve(2);
+  const auto first = store.insert(0, {1, 2});
+  const auto second = store.insert(1, {3, 4}, {.running = true});
+  CHECK(store.size() == 2);
+  CHECK(first == 0);
+  CHECK(store.kindId(second) == 1);
+  CHECK(store.position(second).x == doctest::Approx(3));
+  CHECK(store.animation(second).running);
+  CHECK_FALSE(store.animation(first).running);
+
+  size_t visited{};
+  store.forEach([&visited](ActorSlot) { ++visited; });
+  CHECK(visited == 2);
+
+  store.clear();
+  CHECK(store.size() == 0);
+}
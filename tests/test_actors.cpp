@@ -0,0 +1,114 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_rect.h>
+
+#include <entt/entity/registry.hpp>
+
+#include <vector>
+
+import actors;
+import actorStore;
+import sprite;
+
+namespace {
+/// add an actor of a kind standing at a position
+auto spawn(entt::registry &registry, const CharacterSprite &kind,
+           const SDL_FPoint &pos) -> entt::entity {
+  const auto actor = registry.create();
+  registry.emplace<Position>(actor, Position{.current = pos, .previous = pos});
+  registry.emplace<Sprite>(actor, Sprite{.kind = &kind});
+  registry.emplace<SpriteAnimation>(actor, SpriteAnimation{});
+  return actor;
+}
+} // namespace
+
+TEST_CASE("the actors with a velocity move each simulation step") {
+  const CharacterSprite kind{"knight_m", SDL_FRect{128, 100, 16, 28}, true,
+                             true};
+  entt::registry registry;
+  const auto walker = spawn(registry, kind, {10, 10});
+  registry.emplace<Velocity>(walker, Velocity{.x = 0.5F, .y = -0.25F});
+  const auto idle = spawn(registry, kind, {20, 20});
+
+  moveActors(registry, 4);
+  const auto &position = registry.get<Position>(walker);
+  CHECK(position.previous.x == doctest::Approx(10));
+  CHECK(position.current.x == doctest::Approx(12));
+  CHECK(position.current.y == doctest::Approx(9));
+  CHECK(registry.get<Position>(idle).current.x == doctest::Approx(20));
+
+  std::vector<ActorDraw> draws;
+  collectActors(registry, 0.5F, SDL_FRect{0, 0, 1280, 720}, draws);
+  sortActors(draws);
+  REQUIRE(draws.size() == 2);
+  // sorted by the position of the feet, interpolated between the steps
+  CHECK(draws[0].pos.x == doctest::Approx(11));
+  CHECK(draws[0].sortKey == doctest::Approx(9.5));
+  CHECK(draws[1].pos.x == doctest::Approx(20));
+}
+
+TEST_CASE("only the visible actors with a kind are collected") {
+  const CharacterSprite kind{"goblin", SDL_FRect{368, 32, 16, 16}, true,
+                             false};
+  entt::registry registry;
+  spawn(registry, kind, {100, 100});
+  spawn(registry, kind, {5000, 100});
+  const auto hidden = spawn(registry, kind, {120, 100});
+  registry.get<Sprite>(hidden).kind = nullptr;
+
+  std::vector<ActorDraw> draws;
+  collectActors(registry, 1, SDL_FRect{0, 0, 1280, 720}, draws);
+  REQUIRE(draws.size() == 1);
+  CHECK(draws.front().kind == &kind);
+}
+
+TEST_CASE("a hit lasts a few rendered frames") {
+  const CharacterSprite kind{"knight_m", SDL_FRect{128, 100, 16, 28}, true,
+                             true};
+  entt::registry registry;
+  const auto actor = spawn(registry, kind, {0, 0});
+  auto &animation = registry.get<SpriteAnimation>(actor);
+  animation.hitFrames = CharacterSprite::hitFrameCount;
+  const auto hitRect = kind.getHitTextureRect();
+
+  for (int frame = 0; frame < CharacterSprite::hitFrameCount; ++frame) {
+    CHECK(kind.getTextureRect(animation, 0).x == hitRect.x);
+    animateActors(registry);
+  }
+  CHECK(kind.getTextureRect(animation, 0).x ==
+        kind.getIdleTextureRect(0).x);
+  animation.running = true;
+  CHECK(kind.getTextureRect(animation, 1).x == kind.getRunTextureRect(1).x);
+}
+
+TEST_CASE("the enemies of a level are spawned and collected back") {
+  const std::vector<CharacterSprite> kinds{
+      CharacterSprite{"goblin", SDL_FRect{368, 32, 16, 16}, true, false},
+      CharacterSprite{"chort", SDL_FRect{368, 328, 16, 24}, false, false}};
+  ActorStore level;
+  level.insert(1, {100, 200}, {.running = true});
+  level.insert(0, {100, 100});
+  level.insert(5, {120, 100});
+
+  entt::registry registry;
+  spawnEnemies(registry, level, kinds);
+  // spawning again replaces the enemies
+  spawnEnemies(registry, level, kinds);
+  CHECK(registry.view<const Enemy>().size() == 3);
+
+  std::vector<ActorDraw> draws;
+  collectActors(registry, 1, SDL_FRect{0, 0, 1280, 720}, draws);
+  sortActors(draws);
+  // the enemy of an unknown kind is kept but not drawn
+  REQUIRE(draws.size() == 2);
+  CHECK(draws[0].kind == &kinds[0]);
+  CHECK(draws[1].kind == &kinds[1]);
+  CHECK(draws[1].animation.running);
+
+  ActorStore saved;
+  collectEnemies(registry, saved);
+  CHECK(saved.size() == 3);
+
+  destroyEnemies(registry);
+  CHECK(registry.view<const Enemy>().size() == 0);
+}
@@ -0,0 +1,53 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_rect.h>
+
+#include <sstream>
+#include <string>
+#include <utility>
+
+import catalog;
+import sprite;
+import tile;
+
+TEST_CASE("the catalog stores each name once") {
+  Catalog catalog;
+  const std::string name{"floor_1"};
+  const auto interned = catalog.intern(name);
+  CHECK(interned == name);
+  CHECK(interned.data() != name.data());
+  CHECK(catalog.intern("floor_1").data() == interned.data());
+  // the interned names can be handed to C APIs
+  CHECK(interned.data()[interned.size()] == '\0');
+
+  const auto catalogId =
+      catalog.addTile(name, false, SDL_FRect{16, 64, 16, 16});
+  CHECK(catalog.tile(catalogId).name().data() == interned.data());
+}
+
+TEST_CASE("the catalog indexes the tile kinds by name") {
+  std::istringstream index{"terrain floor_1 16 64 16 16\n"
+                           "terrainA floor_spikes_anim 16 192 16 16\n"
+                           "character knight_m 128 100 16 28\n"
+                           "enemy goblin 368 32 16 16\n"
+                           "enemyw chort 368 328 16 24\n"};
+  Catalog catalog;
+  catalog.load(index);
+
+  REQUIRE(catalog.tiles().size() == 2);
+  CHECK(catalog.findTile("floor_1") == 0);
+  CHECK(catalog.findTile("floor_spikes_anim") == 1);
+  CHECK(catalog.tile(1).isAnimated());
+  CHECK_FALSE(catalog.findTile("knight_m"));
+  CHECK(catalog.characters().size() == 1);
+  CHECK(catalog.enemies().size() == 2);
+  CHECK(catalog.enemies()[1].name() == "chort");
+  CHECK(catalog.findEnemy("chort") == 1);
+  CHECK_FALSE(catalog.findEnemy("floor_1"));
+
+  // moving the catalog keeps the names the kinds reference
+  const auto name = catalog.tile(0).name();
+  const Catalog moved{std::move(catalog)};
+  CHECK(moved.tile(0).name().data() == name.data());
+  CHECK(moved.findTile("floor_1") == 0);
+}
@@ -0,0 +1,69 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_video.h>
+
+#include <vector>
+
+import chunk;
+import grid;
+import sdlHelpers;
+import tile;
+import tileStore;
+
+TEST_CASE("the chunks away from the view release their textures") {
+  const SdlContext context{SDL_INIT_VIDEO, "dummy"};
+  const SdlWindow window{"chunks", {64, 64}, SDL_WINDOW_HIDDEN};
+  const auto renderer = window.createSoftwareRenderer();
+  SpriteBatch batch{renderer};
+
+  // one tile in every fourth chunk of a row, so each view shows one chunk
+  constexpr int chunkCount{6};
+  FloorChunks chunks{2};
+  for (int index = 0; index < chunkCount; ++index) {
+    chunks.insert({.x = index * chunkCells * 4, .y = 0},
+                  static_cast<TileSlot>(index), false);
+  }
+
+  const auto renderChunk = [&](int index) {
+    const auto rect = chunkRect({.x = index * 4, .y = 0});
+    chunks.render(renderer, batch, {rect.x, rect.y, 64, 64}, 0,
+                  [](TileSlot) {});
+  };
+  for (int index = 0; index < chunkCount; ++index) {
+    renderChunk(index);
+    CHECK(chunks.textureCount() <= 2);
+  }
+
+  // an evicted chunk is baked again once visible
+  renderChunk(0);
+  CHECK(chunks.textureCount() == 2);
+  chunks.clear();
+  CHECK(chunks.textureCount() == 0);
+}
+
+TEST_CASE("the tiles larger than a cell are drawn whole past their chunk") {
+  const RendererBuilder column{"column", false, SDL_FRect{80, 80, 16, 48}};
+  const RendererBuilder floor{"floor_1", false, SDL_FRect{16, 64, 16, 16}};
+  CHECK_FALSE(column.isBakeable());
+  CHECK(floor.isBakeable());
+
+  const SdlContext context{SDL_INIT_VIDEO, "dummy"};
+  const SdlWindow window{"chunks", {64, 64}, SDL_WINDOW_HIDDEN};
+  const auto renderer = window.createSoftwareRenderer();
+  SpriteBatch batch{renderer};
+
+  // a column in the top cell of the chunk below the view reaches into it
+  FloorChunks chunks;
+  constexpr TileSlot columnSlot{7};
+  chunks.insert({.x = 0, .y = chunkCells}, columnSlot,
+                !column.isBakeable());
+
+  const auto rect = chunkRect({.x = 0, .y = 0});
+  std::vector<TileSlot> drawn;
+  chunks.render(renderer, batch, {rect.x, rect.y, rect.w, rect.h - 1}, 0,
+                [&drawn](TileSlot slot) { drawn.push_back(slot); });
+  CHECK(drawn == std::vector{columnSlot});
+  CHECK(chunks.textureCount() == 0);
+}
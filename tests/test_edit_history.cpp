@@ -0,0 +1,118 @@
+#include <doctest/doctest.h>
+
+#include <vector>
+
+import editHistory;
+import editor;
+import grid;
+import tileStore;
+
+namespace {
+/// record a group placing a kind on a rectangle of empty cells
+auto placeRectangle(EditHistory &history, const CellArea &area,
+                    CatalogId catalogId) -> void {
+  history.beginGroup(false);
+  area.forEach([&](const Cell &cell) {
+    history.record(cell, TileStore::freeId, false, catalogId, true);
+  });
+  history.endGroup();
+}
+} // namespace
+
+TEST_CASE("the history stores a run per row of a stroke") {
+  EditHistory history;
+  CHECK_FALSE(history.canUndo());
+  placeRectangle(history,
+                 {.first = {.x = -50, .y = 0}, .last = {.x = 49, .y = 9}}, 3);
+  CHECK(history.canUndo());
+  CHECK_FALSE(history.canRedo());
+  // ten rows of a hundred cells
+  CHECK(history.memoryUsage() < 100 * sizeof(DeltaRun));
+
+  std::vector<TileEdit> edits;
+  const auto wall = history.undo(edits);
+  REQUIRE(wall);
+  CHECK_FALSE(*wall);
+  REQUIRE(edits.size() == 1000);
+  CHECK(edits.front().cell == Cell{.x = -50, .y = 0});
+  CHECK(edits.front().catalogId == TileStore::freeId);
+  CHECK(edits.back().cell == Cell{.x = 49, .y = 9});
+
+  CHECK(history.canRedo());
+  REQUIRE(history.redo(edits));
+  REQUIRE(edits.size() == 1000);
+  CHECK(edits.front().catalogId == 3);
+  CHECK(edits.front().level);
+  CHECK_FALSE(history.redo(edits));
+}
+
+TEST_CASE("the history keeps the first and last tile of a cell") {
+  EditHistory history;
+  history.beginGroup(true);
+  history.record({.x = 0, .y = 0}, 1, false, 2, false);
+  history.record({.x = 0, .y = 0}, 2, false, 5, true);
+  history.endGroup();
+  // a change outside a group is not recorded
+  history.record({.x = 1, .y = 0}, 1, false, 2, false);
+
+  std::vector<TileEdit> edits;
+  const auto wall = history.undo(edits);
+  REQUIRE(wall);
+  CHECK(*wall);
+  REQUIRE(edits.size() == 1);
+  CHECK(edits.front().catalogId == 1);
+  CHECK_FALSE(edits.front().level);
+
+  REQUIRE(history.redo(edits));
+  REQUIRE(edits.size() == 1);
+  CHECK(edits.front().catalogId == 5);
+  CHECK(edits.front().level);
+}
+
+TEST_CASE("a new group drops the undone ones") {
+  EditHistory history;
+  const CellArea area{.first = {.x = 0, .y = 0}, .last = {.x = 3, .y = 0}};
+  placeRectangle(history, area, 1);
+  placeRectangle(history, area, 2);
+
+  std::vector<TileEdit> edits;
+  REQUIRE(history.undo(edits));
+  CHECK(history.canRedo());
+  placeRectangle(history, area, 4);
+  CHECK_FALSE(history.canRedo());
+
+  REQUIRE(history.undo(edits));
+  REQUIRE(history.undo(edits));
+  CHECK_FALSE(history.canUndo());
+  REQUIRE(history.redo(edits));
+  CHECK(edits.front().catalogId == 1);
+  REQUIRE(history.redo(edits));
+  CHECK(edits.front().catalogId == 4);
+}
+
+TEST_CASE("the history forgets the oldest groups past its memory cap") {
+  EditHistory history;
+  // a group of one run per row, a row per group
+  for (int y = 0; y < 10; ++y) {
+    placeRectangle(history,
+                   {.first = {.x = 0, .y = y}, .last = {.x = 7, .y = y}}, 1);
+  }
+  const auto usage = history.memoryUsage();
+  history.setMemoryCap(usage / 2);
+  CHECK(history.memoryUsage() <= usage / 2);
+
+  std::vector<TileEdit> edits;
+  int undone{};
+  while (history.undo(edits)) {
+    ++undone;
+  }
+  CHECK(undone > 0);
+  CHECK(undone < 10);
+  // the newest groups are the ones kept
+  CHECK(edits.front().cell.y == 10 - undone);
+
+  history.clear();
+  CHECK_FALSE(history.canUndo());
+  CHECK_FALSE(history.canRedo());
+  CHECK(history.memoryUsage() == 0);
+}
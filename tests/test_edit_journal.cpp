@@ -0,0 +1,110 @@
+#include <doctest/doctest.h>
+
+#include "test_helpers.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+import editJournal;
+import tileStore;
+
+TEST_CASE("an edit journal replays its edits in order") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_edit_journal.journal";
+  std::filesystem::remove(path);
+
+  {
+    EditJournal journal{path};
+    journal.place(false, {.x = 1, .y = 2}, 0, false);
+    journal.place(true, {.x = 3, .y = 4}, 1, true);
+    journal.flush(catalog.tiles());
+    journal.place(false, {.x = 5, .y = 6}, 0, false);
+    journal.erase(false, {.x = 1, .y = 2});
+    journal.flush(catalog.tiles());
+    CHECK(journal.size() == 4);
+  }
+
+  TileStore map;
+  TileStore mapWall;
+  map.insert({.x = 1, .y = 2}, 1, false);
+  CHECK(replayJournal(path, catalog, map, mapWall) == 4);
+  CHECK(map.size() == 1);
+  CHECK_FALSE(map.find({.x = 1, .y = 2}));
+  CHECK(map.find({.x = 5, .y = 6}));
+  REQUIRE(mapWall.size() == 1);
+  const auto wallSlot = mapWall.find({.x = 3, .y = 4});
+  REQUIRE(wallSlot);
+  CHECK(mapWall.catalogId(*wallSlot) == 1);
+  CHECK(mapWall.level(*wallSlot));
+
+  // replaying on a level already containing the edits changes nothing
+  replayJournal(path, catalog, map, mapWall);
+  CHECK(map.size() == 1);
+  CHECK(mapWall.size() == 1);
+}
+
+TEST_CASE("an edit journal ignores a record cut by a crash") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_edit_journal.journal";
+  std::filesystem::remove(path);
+
+  {
+    EditJournal journal{path};
+    journal.place(false, {.x = 1, .y = 2}, 0, false);
+    journal.flush(catalog.tiles());
+  }
+  {
+    std::ofstream file{path, std::ios::binary | std::ios::app};
+    file.write("\1\2\3", 3);
+  }
+
+  TileStore map;
+  TileStore mapWall;
+  CHECK(replayJournal(path, catalog, map, mapWall) == 1);
+  CHECK(map.size() == 1);
+
+  // the records appended after a crash stay aligned
+  {
+    EditJournal journal{path};
+    journal.place(false, {.x = 7, .y = 8}, 0, false);
+    journal.flush(catalog.tiles());
+  }
+  CHECK(replayJournal(path, catalog, map, mapWall) == 2);
+  CHECK(map.size() == 2);
+}
+
+TEST_CASE("a rotated edit journal starts empty") {
+  const auto catalog = testCatalog();
+  const auto directory = std::filesystem::temp_directory_path();
+  const auto path = directory / "test_edit_journal.journal";
+  const auto oldPath = directory / "test_edit_journal.journal.old";
+  std::filesystem::remove(path);
+  std::filesystem::remove(oldPath);
+
+  EditJournal journal{path};
+  CHECK_FALSE(journal.rotate(oldPath));
+  journal.place(false, {.x = 1, .y = 2}, 0, false);
+  journal.flush(catalog.tiles());
+  CHECK(journal.rotate(oldPath));
+  CHECK(journal.size() == 0);
+  journal.place(true, {.x = 3, .y = 4}, 1, false);
+  journal.flush(catalog.tiles());
+
+  TileStore map;
+  TileStore mapWall;
+  CHECK(replayJournal(oldPath, catalog, map, mapWall) == 1);
+  CHECK(replayJournal(path, catalog, map, mapWall) == 1);
+  CHECK(map.size() == 1);
+  CHECK(mapWall.size() == 1);
+}
+
+TEST_CASE("a missing edit journal has no edits") {
+  const auto catalog = testCatalog();
+  TileStore map;
+  TileStore mapWall;
+  CHECK(replayJournal(std::filesystem::temp_directory_path() /
+                          "missing.journal",
+                      catalog, map, mapWall) == 0);
+}
@@ -0,0 +1,89 @@
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <vector>
+
+import editor;
+import grid;
+import tileStore;
+
+TEST_CASE("a line of cells has no gap") {
+  const Cell from{.x = -2, .y = 3};
+  const Cell to{.x = 9, .y = -4};
+  std::vector<Cell> cells;
+  forEachLineCell(from, to, [&cells](const Cell &cell) {
+    cells.push_back(cell);
+  });
+
+  REQUIRE(cells.size() == 12);
+  CHECK(cells.front() == from);
+  CHECK(cells.back() == to);
+  for (size_t index = 1; index < cells.size(); ++index) {
+    CHECK(std::abs(cells[index].x - cells[index - 1].x) <= 1);
+    CHECK(std::abs(cells[index].y - cells[index - 1].y) <= 1);
+  }
+}
+
+TEST_CASE("a paint stroke collects each dragged over cell once") {
+  EditStroke stroke;
+  stroke.begin(EditorTool::paint, false, {.x = 0, .y = 0});
+  stroke.moveTo({.x = 4, .y = 0});
+  stroke.moveTo({.x = 0, .y = 0});
+  CHECK(stroke.isActive());
+  CHECK(stroke.cells().size() == 5);
+
+  stroke.end();
+  CHECK_FALSE(stroke.isActive());
+  CHECK(stroke.cells().empty());
+}
+
+TEST_CASE("a stroke stays in the cells a level holds") {
+  EditStroke stroke;
+  stroke.begin(EditorTool::paint, false, {.x = 65530, .y = 0});
+  stroke.moveTo({.x = 65540, .y = 0});
+  REQUIRE(stroke.cells().size() == 1);
+  CHECK(stroke.cells().front() == storableCells.clamp({.x = 65530, .y = 0}));
+  CHECK(stroke.getAnchor().x == storableCells.last.x);
+}
+
+TEST_CASE("a rectangle stroke covers the cells between its corners") {
+  EditStroke stroke;
+  stroke.begin(EditorTool::rectangle, true, {.x = 3, .y = 5});
+  stroke.moveTo({.x = 1, .y = 1});
+  CHECK(stroke.isErase());
+  CHECK(stroke.cells().empty());
+
+  const auto area = stroke.area();
+  CHECK(area.first == Cell{.x = 1, .y = 1});
+  CHECK(area.last == Cell{.x = 3, .y = 5});
+  int count{};
+  area.forEach([&count](const Cell &) { ++count; });
+  CHECK(count == 15);
+}
+
+TEST_CASE("a flood fill stops at other tiles and at its bounds") {
+  TileStore store;
+  // a wall of kind 1 on column 2, with a hole in row 4
+  for (int y = 0; y < 8; ++y) {
+    if (y != 4) {
+      store.insert({.x = 2, .y = y}, 1, false);
+    }
+  }
+  const CellArea bounds{.first = {.x = 0, .y = 0}, .last = {.x = 4, .y = 7}};
+
+  std::vector<Cell> region;
+  floodFill(store, {.x = 0, .y = 0}, bounds,
+            [&region](const Cell &cell) { region.push_back(cell); });
+  // every empty cell is reached through the hole
+  CHECK(region.size() == (5 * 8) - 7);
+
+  region.clear();
+  floodFill(store, {.x = 2, .y = 0}, bounds,
+            [&region](const Cell &cell) { region.push_back(cell); });
+  CHECK(region.size() == 4);
+
+  region.clear();
+  floodFill(store, {.x = 9, .y = 9}, bounds,
+            [&region](const Cell &cell) { region.push_back(cell); });
+  CHECK(region.empty());
+}
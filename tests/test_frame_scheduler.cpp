@@ -0,0 +1,52 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_stdinc.h>
+
+import frameScheduler;
+
+namespace {
+
+/// clock step of each read, the spin tail moves the fake clock forward
+constexpr Uint64 readStep{1'000};
+
+} // namespace
+
+TEST_CASE("the frame scheduler sleeps then spins until the deadline") {
+  constexpr Uint32 rate{100};
+  constexpr Uint64 period{SDL_NS_PER_SECOND / rate};
+
+  Uint64 now{};
+  Uint64 slept{};
+  FrameScheduler scheduler{rate, [&now] { return now += readStep; },
+                           [&](Uint64 duration) {
+                             slept += duration;
+                             now += duration;
+                           }};
+
+  CHECK(scheduler.waitNextFrame() == 0);
+
+  now += period / 4;
+  const auto interval = scheduler.waitNextFrame();
+  CHECK(interval >= period);
+  CHECK(interval < period + 2 * readStep);
+  CHECK(slept > 0);
+  CHECK(slept < period);
+  CHECK(scheduler.getJitter() < 2 * readStep);
+}
+
+TEST_CASE("a late frame moves the following deadlines") {
+  constexpr Uint32 rate{50};
+  constexpr Uint64 period{SDL_NS_PER_SECOND / rate};
+
+  Uint64 now{};
+  FrameScheduler scheduler{rate, [&now] { return now += readStep; },
+                           [&now](Uint64 duration) { now += duration; }};
+
+  scheduler.waitNextFrame();
+  now += 3 * period;
+  CHECK(scheduler.waitNextFrame() > 3 * period);
+  CHECK(scheduler.getMaxJitter() > 2 * period);
+
+  // the next frame is paced from the late one instead of following at once
+  CHECK(scheduler.waitNextFrame() >= period);
+}
@@ -0,0 +1,35 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_stdinc.h>
+
+import frameStats;
+
+TEST_CASE("the frame stats percentiles cover the history") {
+  FrameStats stats;
+  for (Uint64 frame = 1; frame <= 100; ++frame) {
+    stats.beginFrame(frame * SDL_NS_PER_MS);
+    stats.addPhase(FramePhase::render, SDL_NS_PER_MS);
+    stats.addPhase(FramePhase::render, SDL_NS_PER_MS);
+    stats.endFrame();
+  }
+
+  const auto percentiles = stats.getPercentiles();
+  CHECK(percentiles.p50 == doctest::Approx(50));
+  CHECK(percentiles.p95 == doctest::Approx(95));
+  CHECK(percentiles.p99 == doctest::Approx(99));
+  CHECK(percentiles.max == doctest::Approx(100));
+  CHECK(stats.getPhaseMean(FramePhase::render) == doctest::Approx(2));
+  CHECK(stats.getPhaseMean(FramePhase::present) == doctest::Approx(0));
+}
+
+TEST_CASE("the frame stats history drops the oldest frames") {
+  FrameStats stats;
+  for (size_t frame = 0; frame < FrameStats::historySize + 10; ++frame) {
+    stats.beginFrame(frame < 10 ? 100 * SDL_NS_PER_MS : SDL_NS_PER_MS);
+    stats.endFrame();
+  }
+
+  CHECK(stats.size() == FrameStats::historySize);
+  CHECK(stats.getHistoryOffset() == 10);
+  CHECK(stats.getPercentiles().max == doctest::Approx(1));
+}
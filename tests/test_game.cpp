@@ -0,0 +1,74 @@
+#include <doctest/doctest.h>
+
+#include <SDL3/SDL_stdinc.h>
+
+#include <memory>
+
+import game;
+import level;
+import tileStore;
+
+namespace {
+
+/// a clock moving forward by a fixed step each time it is read, and by the
+/// slept duration when sleeping
+struct FakeClock {
+  Uint64 now{};
+  Uint64 step{};
+};
+
+auto headlessOptions(const std::shared_ptr<FakeClock> &clock) -> GameOptions {
+  return {.headless = true,
+          .clock = [clock] { return clock->now += clock->step; },
+          .sleep = [clock](Uint64 duration) { clock->now += duration; },
+          .journalPath = {}};
+}
+
+} // namespace
+
+TEST_CASE("a headless game renders a frame per call") {
+  constexpr int frames{10};
+
+  auto clock = std::make_shared<FakeClock>(FakeClock{.step = 1'000});
+  Game game{headlessOptions(clock)};
+  for (int i = 0; i < frames; ++i) {
+    game.frame();
+  }
+
+  CHECK(game.frameCount() == frames);
+  CHECK_FALSE(game.done());
+}
+
+TEST_CASE("a headless game waits for the frame duration between frames") {
+  constexpr int frames{12};
+  constexpr Uint64 frameDuration{SDL_NS_PER_SECOND / 30};
+
+  auto clock = std::make_shared<FakeClock>(FakeClock{.step = 1'000});
+  Game game{headlessOptions(clock)};
+  game.frame();
+  const auto start = clock->now;
+  for (int i = 1; i < frames; ++i) {
+    game.frame();
+  }
+
+  const auto elapsed = clock->now - start;
+  CHECK(elapsed >= (frames - 1) * frameDuration);
+  CHECK(elapsed < frames * frameDuration);
+}
+
+TEST_CASE("a level which does not parse leaves the map as it was") {
+  auto clock = std::make_shared<FakeClock>(FakeClock{.step = 1'000});
+  Game game{headlessOptions(clock)};
+  game.parseLevel("floor_1 static 16 64 16 16 32 48 0\n"
+                  "=====\n"
+                  "wall_mid static 32 16 16 16 64 80 1\n");
+  REQUIRE(game.getMap().size() == 1);
+  REQUIRE(game.getMapWall().size() == 1);
+
+  CHECK_THROWS_AS(game.parseLevel("floor_1 static 16 64 16 16 0 16 0\n"
+                                  "floor_1 static 16 6x 16 16 0 32 0\n"),
+                  LevelParseError);
+  CHECK(game.getMap().size() == 1);
+  CHECK(game.getMapWall().size() == 1);
+  CHECK(game.getMap().find({.x = 2, .y = 3}));
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <SDL3/SDL_rect.h>
+
+import catalog;
+
+/// get the catalog the test levels are made of, a floor, a wall and an
+/// animated floor kind, and a running and a walking enemy
+inline auto testCatalog() -> Catalog {
+  Catalog catalog;
+  catalog.addTile("floor_1", false, SDL_FRect{16, 64, 16, 16});
+  catalog.addTile("wall_mid", false, SDL_FRect{32, 16, 16, 16});
+  catalog.addTile("floor_spikes_anim", true, SDL_FRect{16, 176, 16, 16});
+  catalog.addEnemy("goblin", SDL_FRect{368, 32, 16, 16}, true);
+  catalog.addEnemy("chort", SDL_FRect{368, 328, 16, 24}, false);
+  return catalog;
+}
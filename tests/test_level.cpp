@@ -0,0 +1,123 @@
+#include <doctest/doctest.h>
+
+#include "test_helpers.hpp"
+
+#include <sstream>
+#include <string>
+
+import actorStore;
+import level;
+import tileStore;
+
+namespace {
+
+constexpr std::string_view testLevel{"floor_1 static 16 64 16 16 256 384 0\n"
+                                     "unknown static 0 0 16 16 0 16 0\n"
+                                     "floor_1 static 16 64 16 16 32 48 0\n"
+                                     "=====\n"
+                                     "wall_mid static 32 16 16 16 64 80 1\n"
+                                     "=====\n"
+                                     "chort 40.5 72 0\n"
+                                     "unknown 0 0 0\n"
+                                     "goblin 100 200 1\n"};
+
+} // namespace
+
+TEST_CASE("the text parser matches the stream parser") {
+  const auto catalog = testCatalog();
+
+  TileStore streamMap;
+  TileStore streamWall;
+  ActorStore streamEnemies;
+  std::istringstream stream{std::string{testLevel}};
+  loadLevel(stream, catalog, streamMap, streamWall, streamEnemies);
+
+  TileStore map;
+  TileStore mapWall;
+  ActorStore enemies;
+  parseLevel(testLevel, catalog, map, mapWall, enemies);
+
+  REQUIRE(map.size() == streamMap.size());
+  REQUIRE(mapWall.size() == streamWall.size());
+  CHECK(map.size() == 2);
+  CHECK(mapWall.size() == 1);
+  streamMap.forEach([&](TileSlot slot) {
+    const auto found = map.find(streamMap.cell(slot));
+    REQUIRE(found);
+    CHECK(map.catalogId(*found) == streamMap.catalogId(slot));
+  });
+  const auto wallSlot = mapWall.find({.x = 4, .y = 4});
+  REQUIRE(wallSlot);
+  CHECK(mapWall.level(*wallSlot));
+
+  REQUIRE(enemies.size() == 2);
+  REQUIRE(streamEnemies.size() == 2);
+  for (const auto *store : {&enemies, &streamEnemies}) {
+    CHECK(store->kindId(0) == 1);
+    CHECK(store->position(0).x == doctest::Approx(40.5));
+    CHECK_FALSE(store->animation(0).running);
+    CHECK(store->kindId(1) == 0);
+    CHECK(store->animation(1).running);
+  }
+}
+
+TEST_CASE("a saved level parses back with its enemies") {
+  const auto catalog = testCatalog();
+  TileStore map;
+  TileStore mapWall;
+  map.insert({.x = 1, .y = 2}, 0, false);
+  ActorStore enemies;
+  enemies.insert(1, {24, 56});
+  enemies.insert(0, {-8, 16}, {.running = true});
+
+  std::ostringstream stream;
+  saveLevel(stream, catalog.tiles(), map, mapWall, catalog.enemies(),
+            enemies);
+
+  TileStore loadedMap;
+  TileStore loadedWall;
+  ActorStore loadedEnemies;
+  parseLevel(stream.str(), catalog, loadedMap, loadedWall, loadedEnemies);
+  CHECK(loadedMap.size() == 1);
+  CHECK(loadedWall.size() == 0);
+  REQUIRE(loadedEnemies.size() == 2);
+  CHECK(loadedEnemies.kindId(0) == 1);
+  CHECK(loadedEnemies.position(1).x == doctest::Approx(-8));
+  CHECK(loadedEnemies.animation(1).running);
+}
+
+TEST_CASE("the text parser reports the line and column of an error") {
+  const auto catalog = testCatalog();
+  TileStore map;
+  TileStore mapWall;
+  ActorStore enemies;
+
+  const auto errorOf = [&](std::string_view text) -> LevelParseError {
+    try {
+      parseLevel(text, catalog, map, mapWall, enemies);
+    } catch (const LevelParseError &error) {
+      return error;
+    }
+    FAIL("no error reported");
+    return {"", 0, 0};
+  };
+
+  const auto badNumber = errorOf("floor_1 static 16 64 16 16 256 384 0\n"
+                                 "floor_1 static 16 6x 16 16 0 16 0\n");
+  CHECK(badNumber.line() == 2);
+  CHECK(badNumber.column() == 19);
+
+  const auto badType =
+      errorOf("\r\n\r\nfloor_1 moving 16 64 16 16 256 384 0\r\n");
+  CHECK(badType.line() == 3);
+  CHECK(badType.column() == 9);
+
+  const auto missing = errorOf("floor_1 static 16 64 16 16 256\n");
+  CHECK(missing.line() == 1);
+  CHECK(missing.column() == 31);
+
+  // 65536 cells away, the cell would wrap around to x = 0
+  const auto outside =
+      errorOf("\nfloor_1 static 16 64 16 16 1048576 16 0\n");
+  CHECK(outside.line() == 2);
+}
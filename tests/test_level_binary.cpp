@@ -0,0 +1,118 @@
+#include <doctest/doctest.h>
+
+#include "test_helpers.hpp"
+
+#include <SDL3/SDL_rect.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <vector>
+
+import actorStore;
+import catalog;
+import grid;
+import levelBinary;
+import tile;
+import tileStore;
+
+namespace {
+
+auto levelPath() -> std::filesystem::path {
+  return std::filesystem::temp_directory_path() / "test_level_binary.lvlb";
+}
+
+} // namespace
+
+TEST_CASE("a binary level keeps the tiles of both layers and the enemies") {
+  const auto catalog = testCatalog();
+  TileStore map;
+  TileStore mapWall;
+  map.insert({.x = 1, .y = 2}, 0, false);
+  map.insert({.x = -3, .y = 4}, 2, false);
+  mapWall.insert({.x = 5, .y = -6}, 1, true);
+  ActorStore enemies;
+  enemies.insert(1, {40.5F, 72});
+  enemies.insert(0, {-8, 16}, {.running = true});
+
+  {
+    std::ofstream file{levelPath(), std::ios::binary | std::ios::trunc};
+    saveBinaryLevel(file, catalog.tiles(), map, mapWall, catalog.enemies(),
+                    enemies);
+  }
+
+  const MappedLevel level{levelPath()};
+  CHECK(level.getHeader().version == binaryLevelVersion);
+  CHECK(level.getCatalog().entries.size() == catalog.tiles().size());
+  CHECK(level.getCatalog().name(1) == "wall_mid");
+  CHECK(level.floor().size() == 2);
+  CHECK(level.wall().size() == 1);
+  CHECK(level.getEnemyCatalog().name(1) == "chort");
+  CHECK(level.enemies().size() == 2);
+
+  // the catalog order of the game may differ from the file one
+  Catalog reordered;
+  for (auto kindIt = catalog.tiles().rbegin(); kindIt != catalog.tiles().rend();
+       ++kindIt) {
+    reordered.addTile(kindIt->name(), kindIt->isAnimated(),
+                      kindIt->getSourceRect());
+  }
+  reordered.addEnemy("chort", SDL_FRect{368, 328, 16, 24}, false);
+  reordered.addEnemy("goblin", SDL_FRect{368, 32, 16, 16}, true);
+  TileStore loadedMap;
+  TileStore loadedWall;
+  ActorStore loadedEnemies;
+  loadBinaryLevel(level, reordered, loadedMap, loadedWall, loadedEnemies);
+
+  REQUIRE(loadedMap.size() == 2);
+  REQUIRE(loadedWall.size() == 1);
+  const auto floorSlot = loadedMap.find({.x = -3, .y = 4});
+  REQUIRE(floorSlot);
+  CHECK(loadedMap.catalogId(*floorSlot) == 0);
+  const auto wallSlot = loadedWall.find({.x = 5, .y = -6});
+  REQUIRE(wallSlot);
+  CHECK(loadedWall.catalogId(*wallSlot) == 1);
+  CHECK(loadedWall.level(*wallSlot));
+
+  REQUIRE(loadedEnemies.size() == 2);
+  CHECK(loadedEnemies.kindId(0) == 0);
+  CHECK(loadedEnemies.position(0).x == doctest::Approx(40.5));
+  CHECK_FALSE(loadedEnemies.animation(0).running);
+  CHECK(loadedEnemies.kindId(1) == 1);
+  CHECK(loadedEnemies.position(1).y == doctest::Approx(16));
+  CHECK(loadedEnemies.animation(1).running);
+}
+
+TEST_CASE("a file that is not a binary level is rejected") {
+  {
+    std::ofstream file{levelPath(), std::ios::trunc};
+    file << "floor_1 static 16 64 16 16 16 32 0\n=====\n";
+  }
+
+  CHECK_THROWS_AS(MappedLevel{levelPath()}, LevelFormatError);
+}
+
+TEST_CASE("a catalog table reads back the names it was written with") {
+  const auto catalog = testCatalog();
+  std::ostringstream stream;
+  writeCatalogTable(stream, catalog.tiles());
+  auto bytes = stream.str();
+  const auto count = static_cast<std::uint32_t>(catalog.tiles().size());
+  const auto namesSize = catalogNamesSize(catalog.tiles());
+
+  const auto table =
+      readCatalogTable(std::as_bytes(std::span{bytes}), 0, count, namesSize);
+  REQUIRE(table);
+  CHECK(table->end == bytes.size());
+  CHECK(table->name(2) == "floor_spikes_anim");
+  CHECK(table->matchTiles(catalog) == std::vector<CatalogId>{0, 1, 2});
+
+  // a name past the end of the names is rejected
+  const BinaryCatalogEntry entry{.nameOffset = 1000, .nameLength = 1};
+  bytes.replace(0, sizeof(entry), reinterpret_cast<const char *>(&entry),
+                sizeof(entry));
+  CHECK_FALSE(
+      readCatalogTable(std::as_bytes(std::span{bytes}), 0, count, namesSize));
+}
@@ -0,0 +1,140 @@
+#include <doctest/doctest.h>
+
+#include "test_helpers.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <thread>
+
+import actorStore;
+import levelBinary;
+import levelLoader;
+import levelSaver;
+import tileStore;
+
+namespace {
+
+/// wait for the loader to leave the loading state
+auto waitForLoad(const AsyncLevelLoader &loader) -> void {
+  using namespace std::chrono_literals;
+  const auto deadline = std::chrono::steady_clock::now() + 10s;
+  while (loader.isLoading() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+} // namespace
+
+TEST_CASE("the level loader builds the level and its indices") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_level_loader.lvl";
+  {
+    std::ofstream file{path, std::ios::trunc};
+    for (int x = 0; x < 100; ++x) {
+      file << "floor_1 static 16 64 16 16 " << x * 16 << " 32 0\n";
+    }
+    file << "=====\nwall_mid static 32 16 16 16 64 80 1\n";
+  }
+
+  AsyncLevelLoader loader;
+  loader.start(path, catalog);
+  waitForLoad(loader);
+
+  auto level = loader.takeLoaded();
+  REQUIRE(level);
+  CHECK(level->map.size() == 100);
+  CHECK(level->mapWall.size() == 1);
+  CHECK(loader.getProgress() == doctest::Approx(1));
+  CHECK_FALSE(loader.takeLoaded());
+}
+
+TEST_CASE("the level loader loads a binary level") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_level_loader.lvlb";
+  {
+    TileStore map;
+    TileStore mapWall;
+    map.insert({.x = 1, .y = 2}, 0, false);
+    mapWall.insert({.x = 4, .y = 5}, 1, true);
+    ActorStore enemies;
+    enemies.insert(0, {24, 56});
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    saveBinaryLevel(file, catalog.tiles(), map, mapWall, catalog.enemies(),
+                    enemies);
+  }
+
+  AsyncLevelLoader loader;
+  loader.startBinary(path, catalog);
+  waitForLoad(loader);
+
+  auto level = loader.takeLoaded();
+  REQUIRE(level);
+  CHECK(level->format == LevelFormat::binary);
+  CHECK(level->map.size() == 1);
+  CHECK(level->mapWall.size() == 1);
+  CHECK(level->enemies.size() == 1);
+}
+
+TEST_CASE("a placed enemy survives a save and a load in the background") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_level_round_trip.lvl";
+
+  TileStore map;
+  const TileStore mapWall;
+  map.insert({.x = 1, .y = 2}, 0, false);
+  ActorStore enemies;
+  enemies.insert(1, {40.5F, 72}, {.running = true});
+  {
+    AsyncLevelSaver saver;
+    saver.save(path, catalog.tiles(), map, mapWall, catalog.enemies(),
+               enemies);
+    saver.wait();
+    REQUIRE_FALSE(saver.takeError());
+  }
+
+  AsyncLevelLoader loader;
+  loader.start(path, catalog);
+  waitForLoad(loader);
+
+  auto level = loader.takeLoaded();
+  REQUIRE(level);
+  REQUIRE(level->enemies.size() == 1);
+  CHECK(level->enemies.kindId(0) == 1);
+  CHECK(level->enemies.position(0).x == doctest::Approx(40.5));
+  CHECK(level->enemies.position(0).y == doctest::Approx(72));
+  CHECK(level->enemies.animation(0).running);
+}
+
+TEST_CASE("a cancelled level load has no result") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_level_loader.lvl";
+  {
+    std::ofstream file{path, std::ios::trunc};
+    file << "floor_1 static 16 64 16 16 0 32 0\n";
+  }
+
+  AsyncLevelLoader loader;
+  loader.start(path, catalog);
+  loader.cancel();
+
+  CHECK_FALSE(loader.isLoading());
+  CHECK_FALSE(loader.takeLoaded());
+}
+
+TEST_CASE("a failed level load reports its error") {
+  const auto catalog = testCatalog();
+
+  AsyncLevelLoader loader;
+  loader.start(std::filesystem::temp_directory_path() / "missing.lvl",
+               catalog);
+  waitForLoad(loader);
+
+  CHECK_FALSE(loader.takeLoaded());
+  CHECK(loader.takeError());
+}
@@ -0,0 +1,75 @@
+#include <doctest/doctest.h>
+
+#include "test_helpers.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+import actorStore;
+import level;
+import levelBinary;
+import levelSaver;
+import tileStore;
+
+TEST_CASE("the level saver writes the snapshot taken when saving") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_level_saver.lvl";
+
+  TileStore map;
+  TileStore mapWall;
+  map.insert({.x = 1, .y = 2}, 0, false);
+  mapWall.insert({.x = 3, .y = 4}, 1, true);
+  ActorStore enemies;
+  enemies.insert(0, {40, 72});
+
+  AsyncLevelSaver saver;
+  saver.save(path, catalog.tiles(), map, mapWall, catalog.enemies(), enemies);
+  // changes made after save() are not part of the snapshot
+  map.insert({.x = 5, .y = 6}, 0, false);
+  enemies.insert(0, {80, 72});
+  saver.wait();
+
+  CHECK_FALSE(saver.isSaving());
+  CHECK_FALSE(saver.takeError());
+  CHECK_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+  std::ifstream file{path};
+  TileStore loadedMap;
+  TileStore loadedWall;
+  ActorStore loadedEnemies;
+  loadLevel(file, catalog, loadedMap, loadedWall, loadedEnemies);
+  CHECK(loadedMap.size() == 1);
+  CHECK(loadedWall.size() == 1);
+  CHECK(loadedEnemies.size() == 1);
+}
+
+TEST_CASE("a binary save does not replace the text save waiting") {
+  const auto catalog = testCatalog();
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_level_saver.lvl";
+  auto binaryPath = path;
+  binaryPath += "b";
+  std::filesystem::remove(path);
+  std::filesystem::remove(binaryPath);
+
+  TileStore map;
+  TileStore mapWall;
+  map.insert({.x = 1, .y = 2}, 0, false);
+  const ActorStore enemies;
+
+  AsyncLevelSaver saver;
+  bool written{};
+  saver.save(path, catalog.tiles(), map, mapWall, catalog.enemies(), enemies,
+             [&written] { written = true; });
+  saver.saveBinary(binaryPath, catalog.tiles(), map, mapWall,
+                   catalog.enemies(), enemies);
+  saver.wait();
+
+  CHECK_FALSE(saver.takeError());
+  CHECK(written);
+  CHECK(std::filesystem::exists(path));
+  const MappedLevel level{binaryPath};
+  CHECK(level.floor().size() == 1);
+}
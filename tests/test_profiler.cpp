@@ -0,0 +1,54 @@
+#include <doctest/doctest.h>
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+import profiler;
+
+TEST_CASE("the profiling zones of every thread are dumped") {
+  {
+    const ProfileZone zone{"test main thread"};
+  }
+  std::thread{[] { const ProfileZone zone{"test worker thread"}; }}.join();
+
+  std::ostringstream trace;
+  dumpChromeTrace(trace);
+  const auto text = trace.str();
+
+  CHECK(text.starts_with("{\"traceEvents\":["));
+  if constexpr (profilingEnabled) {
+    CHECK(text.find(R"("name":"test main thread")") != std::string::npos);
+    CHECK(text.find(R"("name":"test worker thread")") != std::string::npos);
+  } else {
+    CHECK(text.find("test main thread") == std::string::npos);
+  }
+}
+
+TEST_CASE("the threads recording one after another share a buffer") {
+  constexpr int threads{8};
+  for (int thread = 0; thread < threads; ++thread) {
+    std::thread{[] { const ProfileZone zone{"test recycled thread"}; }}.join();
+  }
+
+  std::ostringstream trace;
+  dumpChromeTrace(trace);
+  const auto text = trace.str();
+
+  if constexpr (profilingEnabled) {
+    constexpr std::string_view name{R"("name":"test recycled thread")"};
+    constexpr std::string_view tid{R"("tid":)"};
+    std::set<std::string> tids;
+    int events{};
+    for (auto position = text.find(name); position != std::string::npos;
+         position = text.find(name, position + 1)) {
+      const auto tidStart = text.find(tid, position) + tid.size();
+      tids.insert(text.substr(tidStart, text.find('}', tidStart) - tidStart));
+      ++events;
+    }
+    CHECK(events == threads);
+    CHECK(tids.size() == 1);
+  }
+}
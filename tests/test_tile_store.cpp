@@ -0,0 +1,115 @@
+#include <doctest/doctest.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+import grid;
+import tileStore;
+
+TEST_CASE("a tile store finds the tile of a cell") {
+  TileStore store;
+  CHECK_FALSE(store.find({.x = 0, .y = 0}));
+
+  const auto slot = store.insert({.x = -3, .y = 7}, 2, true);
+  CHECK(store.find({.x = -3, .y = 7}) == slot);
+  CHECK_FALSE(store.find({.x = 7, .y = -3}));
+
+  store.erase(slot);
+  CHECK_FALSE(store.find({.x = -3, .y = 7}));
+  CHECK(store.size() == 0);
+}
+
+TEST_CASE("a tile store keeps one tile per cell") {
+  TileStore store;
+  const auto slot = store.insert({.x = 1, .y = 2}, 0, false);
+  CHECK(store.insert({.x = 1, .y = 2}, 3, true) == slot);
+  CHECK(store.size() == 1);
+  CHECK(store.catalogId(slot) == 3);
+  CHECK(store.level(slot));
+}
+
+TEST_CASE("a tile store indexes many cells through erasures") {
+  constexpr int side{200};
+  TileStore store;
+  for (int y = 0; y < side; ++y) {
+    for (int x = 0; x < side; ++x) {
+      store.insert({.x = x - (side / 2), .y = y - (side / 2)},
+                   static_cast<CatalogId>(x % 4), false);
+    }
+  }
+  CHECK(store.size() == side * side);
+
+  // erase one cell out of three, the others stay reachable
+  for (int y = 0; y < side; ++y) {
+    for (int x = 0; x < side; ++x) {
+      const Cell cell{.x = x - (side / 2), .y = y - (side / 2)};
+      if ((x + y) % 3 == 0) {
+        const auto slot = store.find(cell);
+        REQUIRE(slot);
+        store.erase(*slot);
+      }
+    }
+  }
+
+  size_t found{};
+  for (int y = 0; y < side; ++y) {
+    for (int x = 0; x < side; ++x) {
+      const Cell cell{.x = x - (side / 2), .y = y - (side / 2)};
+      const auto slot = store.find(cell);
+      CHECK(slot.has_value() == ((x + y) % 3 != 0));
+      if (slot) {
+        CHECK(store.cell(*slot) == cell);
+        ++found;
+      }
+    }
+  }
+  CHECK(found == store.size());
+}
+
+TEST_CASE("a tile store only holds the cells packed without loss") {
+  TileStore store;
+  const auto slot = store.insert({.x = 0, .y = 0}, 1, false);
+  CHECK_THROWS_AS(store.insert({.x = 65536, .y = 0}, 2, false),
+                  std::out_of_range);
+  CHECK_FALSE(store.find({.x = 65536, .y = 0}));
+  CHECK(store.catalogId(slot) == 1);
+
+  const auto corner = storableCells.first;
+  CHECK_FALSE(store.find(corner));
+  store.insert(corner, 3, false);
+  CHECK(store.find(corner));
+  CHECK_THROWS_AS(store.insert({.x = corner.x - 1, .y = corner.y - 1}, 3,
+                               false),
+                  std::out_of_range);
+  CHECK(store.size() == 2);
+}
+
+TEST_CASE("a tile store is filled in bulk like tile by tile") {
+  const std::vector<TileStore::PackedTile> tiles{
+      {.cell = packCell({.x = 1, .y = 2}), .catalogId = 0, .level = false},
+      {.cell = packCell({.x = -3, .y = 4}), .catalogId = TileStore::freeId,
+       .level = false},
+      {.cell = packCell({.x = 5, .y = -6}), .catalogId = 2, .level = true},
+      {.cell = packCell({.x = 1, .y = 2}), .catalogId = 1, .level = true}};
+
+  TileStore store;
+  store.insert({.x = 7, .y = 7}, 0, false);
+  store.assign(tiles, [](const TileStore::PackedTile &tile) { return tile; });
+
+  CHECK(store.size() == 2);
+  CHECK_FALSE(store.find({.x = 7, .y = 7}));
+  CHECK_FALSE(store.find({.x = -3, .y = 4}));
+  const auto last = store.find({.x = 1, .y = 2});
+  REQUIRE(last);
+  CHECK(store.catalogId(*last) == 1);
+  CHECK(store.level(*last));
+  const auto wall = store.find({.x = 5, .y = -6});
+  REQUIRE(wall);
+  CHECK(store.catalogId(*wall) == 2);
+
+  // the slot of the replaced tile is reused
+  const auto slot = store.insert({.x = 8, .y = 8}, 0, false);
+  CHECK(store.slotCount() == 3);
+  CHECK(store.cell(slot) == Cell{.x = 8, .y = 8});
+}
@@ -0,0 +1,255 @@
+// Pack the tileset frames into power of two texture atlases.
+//
+// usage: atlas_packer <frames directory> <tile list> <output directory>
+//
+// Every png of the frames directory is packed. The frames of the characters
+// listed in the tile list are packed a second time mirrored horizontally, so
+// a sprite looking left does not need a flipped draw. The output directory
+// receives atlas_<index>.png and atlas_catalog.hpp, a constexpr catalog of
+// the frames source rectangles.
+
+#include "SDL3/SDL.h"
+#include "SDL3_image/SDL_image.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// Used to auto delete SDL_Surface
+using SdlSurfacePtr = std::unique_ptr<SDL_Surface, void (*)(SDL_Surface *)>;
+
+/// the biggest atlas side in pixels
+constexpr int maxAtlasSize{1024};
+/// the empty pixels around each frame, avoids sampling the neighbours
+constexpr int framePadding{1};
+
+/// a frame to pack
+struct Frame {
+  std::string name;
+  SdlSurfacePtr surface;
+  bool mirrored{};
+  /// the atlas containing the frame, set by pack()
+  int atlas{};
+  /// the frame area in its atlas, set by pack()
+  SDL_Rect rect{};
+};
+
+/// an atlas being filled by rows of frames
+struct Atlas {
+  int width{};
+  int height{};
+  int rowX{};
+  int rowY{};
+  int rowHeight{};
+};
+
+/// get the smallest power of two not lower than a value
+auto nextPowerOfTwo(int value) -> int {
+  int power{1};
+  while (power < value) {
+    power *= 2;
+  }
+  return power;
+}
+
+/// read the names of the characters from the tile list
+auto loadCharacterNames(const std::filesystem::path &tileList)
+    -> std::vector<std::string> {
+  std::ifstream file{tileList};
+  if (!file) {
+    throw std::runtime_error{
+        std::format("can not open {}", tileList.string())};
+  }
+
+  std::vector<std::string> names;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream lineStream{line};
+    std::string type;
+    std::string name;
+    if (lineStream >> type >> name && type == "character") {
+      names.push_back(name + '_');
+    }
+  }
+  return names;
+}
+
+/// load the frames of a directory and the mirrored character frames
+auto loadFrames(const std::filesystem::path &directory,
+                const std::vector<std::string> &characterNames)
+    -> std::vector<Frame> {
+  std::vector<Frame> frames;
+  for (const auto &entry : std::filesystem::directory_iterator{directory}) {
+    if (entry.path().extension() != ".png") {
+      continue;
+    }
+
+    SdlSurfacePtr surface{IMG_Load(entry.path().string().c_str()),
+                          SDL_DestroySurface};
+    if (!surface) {
+      throw std::runtime_error{std::format("IMG_Load(): {}", SDL_GetError())};
+    }
+    SDL_SetSurfaceBlendMode(surface.get(), SDL_BLENDMODE_NONE);
+
+    auto name = entry.path().stem().string();
+    const bool isCharacter = std::ranges::any_of(
+        characterNames,
+        [&name](const auto &prefix) { return name.starts_with(prefix); });
+    if (isCharacter) {
+      SdlSurfacePtr mirrored{SDL_DuplicateSurface(surface.get()),
+                             SDL_DestroySurface};
+      if (!mirrored || !SDL_FlipSurface(mirrored.get(), SDL_FLIP_HORIZONTAL)) {
+        throw std::runtime_error{
+            std::format("SDL_FlipSurface(): {}", SDL_GetError())};
+      }
+      frames.push_back({.name = name + "_mirrored",
+                        .surface = std::move(mirrored),
+                        .mirrored = true});
+    }
+    frames.push_back({.name = std::move(name), .surface = std::move(surface)});
+  }
+  return frames;
+}
+
+/// place the frames in atlases, tallest frames first
+auto pack(std::vector<Frame> &frames) -> std::vector<Atlas> {
+  std::ranges::sort(frames, [](const Frame &lhs, const Frame &rhs) {
+    if (lhs.surface->h != rhs.surface->h) {
+      return lhs.surface->h > rhs.surface->h;
+    }
+    return lhs.name < rhs.name;
+  });
+
+  std::vector<Atlas> atlases(1);
+  for (auto &frame : frames) {
+    const int width = frame.surface->w + (2 * framePadding);
+    const int height = frame.surface->h + (2 * framePadding);
+    if (width > maxAtlasSize || height > maxAtlasSize) {
+      throw std::runtime_error{std::format("{} is too big", frame.name)};
+    }
+
+    auto *atlas = &atlases.back();
+    if (atlas->rowX + width > maxAtlasSize) {
+      atlas->rowX = 0;
+      atlas->rowY += atlas->rowHeight;
+      atlas->rowHeight = 0;
+    }
+    if (atlas->rowY + height > maxAtlasSize) {
+      atlas = &atlases.emplace_back();
+    }
+
+    frame.atlas = static_cast<int>(atlases.size() - 1);
+    frame.rect = {atlas->rowX + framePadding, atlas->rowY + framePadding,
+                  frame.surface->w, frame.surface->h};
+
+    atlas->rowX += width;
+    atlas->rowHeight = std::max(atlas->rowHeight, height);
+    atlas->width = std::max(atlas->width, atlas->rowX);
+    atlas->height = std::max(atlas->height, atlas->rowY + atlas->rowHeight);
+  }
+
+  for (auto &atlas : atlases) {
+    atlas.width = nextPowerOfTwo(atlas.width);
+    atlas.height = nextPowerOfTwo(atlas.height);
+  }
+  return atlases;
+}
+
+/// render the atlases and save them as png
+auto saveAtlases(const std::vector<Frame> &frames,
+                 const std::vector<Atlas> &atlases,
+                 const std::filesystem::path &outputDirectory) -> void {
+  for (size_t index = 0; index < atlases.size(); ++index) {
+    const SdlSurfacePtr surface{SDL_CreateSurface(atlases[index].width,
+                                                  atlases[index].height,
+                                                  SDL_PIXELFORMAT_RGBA32),
+                                SDL_DestroySurface};
+    if (!surface) {
+      throw std::runtime_error{
+          std::format("SDL_CreateSurface(): {}", SDL_GetError())};
+    }
+
+    for (const auto &frame : frames) {
+      if (std::cmp_equal(frame.atlas, index)) {
+        SDL_BlitSurface(frame.surface.get(), nullptr, surface.get(),
+                        &frame.rect);
+      }
+    }
+
+    const auto path = outputDirectory / std::format("atlas_{}.png", index);
+    if (!IMG_SavePNG(surface.get(), path.string().c_str())) {
+      throw std::runtime_error{
+          std::format("IMG_SavePNG(): {}", SDL_GetError())};
+    }
+  }
+}
+
+/// write the constexpr frame catalog
+auto saveCatalog(std::vector<Frame> &frames,
+                 const std::filesystem::path &outputDirectory) -> void {
+  std::ranges::sort(frames, {}, &Frame::name);
+
+  std::ofstream file{outputDirectory / "atlas_catalog.hpp"};
+  file << "// generated by atlas_packer, do not edit\n"
+          "#pragma once\n\n"
+          "#include <array>\n"
+          "#include <string_view>\n\n"
+          "namespace atlas {\n\n"
+          "/// a frame of the packed atlases\n"
+          "struct Frame {\n"
+          "  std::string_view name;\n"
+          "  int atlas;\n"
+          "  float x;\n"
+          "  float y;\n"
+          "  float w;\n"
+          "  float h;\n"
+          "  bool mirrored;\n"
+          "};\n\n"
+       << std::format("inline constexpr std::array<Frame, {}> frames{{{{\n",
+                      frames.size());
+  for (const auto &frame : frames) {
+    file << std::format("    {{\"{}\", {}, {}, {}, {}, {}, {}}},\n", frame.name,
+                        frame.atlas, frame.rect.x, frame.rect.y, frame.rect.w,
+                        frame.rect.h, frame.mirrored);
+  }
+  file << "}};\n\n} // namespace atlas\n";
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  if (argc != 4) {
+    std::cerr << "usage: atlas_packer <frames directory> <tile list> "
+                 "<output directory>\n";
+    return EXIT_FAILURE;
+  }
+
+  try {
+    const std::vector<std::string> arguments{argv + 1, argv + argc};
+    const std::filesystem::path outputDirectory{arguments[2]};
+    std::filesystem::create_directories(outputDirectory);
+
+    auto frames = loadFrames(arguments[0], loadCharacterNames(arguments[1]));
+    const auto atlases = pack(frames);
+    saveAtlases(frames, atlases, outputDirectory);
+    saveCatalog(frames, outputDirectory);
+
+    std::cout << std::format("packed {} frames in {} atlases\n", frames.size(),
+                             atlases.size());
+  } catch (const std::exception &error) {
+    std::cerr << error.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
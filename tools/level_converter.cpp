@@ -0,0 +1,99 @@
+// Convert a text level to the binary level format.
+//
+// usage: level_converter <text level> <binary level>
+//
+// The tile and enemy kinds of the binary level are the ones named in the text
+// level, in the order they first appear, so the converter does not need the
+// tileset.
+
+#include <SDL3/SDL_rect.h>
+
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+import actorStore;
+import catalog;
+import level;
+import levelBinary;
+import tile;
+import tileStore;
+
+namespace {
+
+/// collect the tile and enemy kinds named in a text level
+auto readCatalog(const std::string &text) -> Catalog {
+  Catalog catalog;
+
+  std::istringstream lines{text};
+  std::string line;
+  // the enemies follow the second separator
+  int separators{};
+  while (std::getline(lines, line)) {
+    if (line == levelLayerSeparator) {
+      ++separators;
+      continue;
+    }
+    std::istringstream lineStream{line};
+    if (separators < 2) {
+      TileRecord record;
+      if (lineStream >> record && !catalog.findTile(record.name)) {
+        catalog.addTile(record.name, record.animated, record.sourceRect);
+      }
+    } else if (std::string name;
+               lineStream >> name && !catalog.findEnemy(name)) {
+      // a binary level only holds the names of the enemy kinds
+      catalog.addEnemy(name, SDL_FRect{}, true);
+    }
+  }
+  return catalog;
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  if (argc != 3) {
+    std::cerr << "usage: level_converter <text level> <binary level>\n";
+    return EXIT_FAILURE;
+  }
+
+  try {
+    const std::vector<std::string> arguments{argv + 1, argv + argc};
+
+    std::ifstream input{arguments[0]};
+    if (!input) {
+      std::cerr << std::format("can not open {}\n", arguments[0]);
+      return EXIT_FAILURE;
+    }
+    std::ostringstream text;
+    text << input.rdbuf();
+
+    const auto catalog = readCatalog(text.str());
+    TileStore map;
+    TileStore mapWall;
+    ActorStore enemies;
+    std::istringstream level{text.str()};
+    loadLevel(level, catalog, map, mapWall, enemies);
+
+    std::ofstream output{arguments[1], std::ios::binary | std::ios::trunc};
+    saveBinaryLevel(output, catalog.tiles(), map, mapWall, catalog.enemies(),
+                    enemies);
+    if (!output) {
+      std::cerr << std::format("can not write {}\n", arguments[1]);
+      return EXIT_FAILURE;
+    }
+
+    std::cout << std::format(
+        "converted {} floor and {} wall tiles of {} kinds and {} enemies\n",
+        map.size(), mapWall.size(), catalog.tiles().size(), enemies.size());
+  } catch (const std::exception &error) {
+    std::cerr << error.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}